@@ -0,0 +1,329 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор, выполняющий целенаправленный поиск A* с ориентирами (ALT).
+// При построении выбираются вершины-ориентиры и для каждой рассчитываются
+// расстояния от неё до всех вершин и от всех вершин до неё. По неравенству
+// треугольника эти расстояния дают нижнюю оценку пути до цели, которая
+// отсекает вершины, не ведущие к ней
+template <typename Weight>
+class AltRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    static constexpr size_t DEFAULT_LANDMARK_COUNT = 8;
+
+    // Данные ориентиров, сохраняемые в базе. Расстояния хранятся по вершинам:
+    // элемент [vertex * landmarks.size() + i] относится к ориентиру i
+    struct Data {
+        std::vector<VertexId> landmarks;
+        // Расстояния от ориентира до вершины
+        std::vector<Weight> forward_distances;
+        // Расстояния от вершины до ориентира
+        std::vector<Weight> backward_distances;
+    };
+
+    // Выбор ориентиров и расчёт расстояний по графу
+    explicit AltRouter(const Graph& graph, size_t landmark_count = DEFAULT_LANDMARK_COUNT);
+
+    // Конструктор, принимающий готовые данные ориентиров без повторного расчёта
+    AltRouter(const Graph& graph, Data data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    const Data& GetData() const {
+        return data_;
+    }
+
+    SearchStats GetStats() const {
+        return { query_count_.load(), settled_vertex_count_.load() };
+    }
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NONE_EDGE = std::numeric_limits<EdgeId>::max();
+
+    void SelectLandmarks(size_t landmark_count);
+
+    // Расчёт расстояний от вершины по исходящим рёбрам (reverse = false)
+    // или до вершины по входящим рёбрам (reverse = true)
+    std::vector<Weight> ComputeDistances(VertexId source, bool reverse) const;
+
+    // Нижняя оценка веса пути от вершины до цели; недостижимость цели
+    // обозначается значением UNREACHABLE_WEIGHT
+    Weight GetPotential(VertexId vertex, VertexId to) const;
+
+    const Graph& graph_;
+    Data data_;
+    // Входящие рёбра вершин в форме CSR, нужны только при построении
+    std::vector<size_t> reverse_offsets_;
+    std::vector<EdgeId> reverse_edges_;
+
+    mutable std::atomic<size_t> query_count_ = 0;
+    mutable std::atomic<size_t> settled_vertex_count_ = 0;
+};
+
+template <typename Weight>
+AltRouter<Weight>::AltRouter(const Graph& graph, size_t landmark_count) : graph_(graph) {
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    SelectLandmarks(landmark_count);
+}
+
+template <typename Weight>
+AltRouter<Weight>::AltRouter(const Graph& graph, Data data) : graph_(graph), data_(std::move(data)) {
+    const size_t cell_count = graph.GetVertexCount() * data_.landmarks.size();
+
+    if (data_.forward_distances.size() != cell_count || data_.backward_distances.size() != cell_count) {
+        throw std::invalid_argument("Landmarks data doesn't match the graph");
+    }
+}
+
+// Ориентиры выбираются по принципу наибольшей удалённости: очередной ориентир -
+// вершина, сумма расстояний до которой и от которой для ближайшего из уже
+// выбранных ориентиров максимальна. Вершины, не связанные ни с одним ориентиром,
+// выбираются в первую очередь, поэтому каждая компонента получает свой ориентир
+template <typename Weight>
+void AltRouter<Weight>::SelectLandmarks(size_t landmark_count) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    landmark_count = std::min(landmark_count, vertex_count);
+
+    if (landmark_count == 0) {
+        return;
+    }
+
+    reverse_offsets_.assign(vertex_count + 1, 0);
+    reverse_edges_.resize(graph_.GetEdgeCount());
+
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        ++reverse_offsets_[graph_.GetEdge(edge_id).to + 1];
+    }
+    for (size_t i = 0; i < vertex_count; ++i) {
+        reverse_offsets_[i + 1] += reverse_offsets_[i];
+    }
+
+    std::vector<size_t> next(reverse_offsets_.begin(), reverse_offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        reverse_edges_[next[graph_.GetEdge(edge_id).to]++] = edge_id;
+    }
+
+    // Первый ориентир - вершина, наиболее удалённая от нулевой
+    std::vector<Weight> cover_weights = ComputeDistances(0, false);
+    std::vector<std::vector<Weight>> forward_distances;
+    std::vector<std::vector<Weight>> backward_distances;
+
+    while (data_.landmarks.size() < landmark_count) {
+        VertexId landmark = 0;
+        for (VertexId vertex = 1; vertex < vertex_count; ++vertex) {
+            if (cover_weights[vertex] > cover_weights[landmark]) {
+                landmark = vertex;
+            }
+        }
+
+        data_.landmarks.push_back(landmark);
+        forward_distances.push_back(ComputeDistances(landmark, false));
+        backward_distances.push_back(ComputeDistances(landmark, true));
+
+        if (data_.landmarks.size() == 1) {
+            cover_weights.assign(vertex_count, UNREACHABLE_WEIGHT);
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            const Weight forward = forward_distances.back()[vertex];
+            const Weight backward = backward_distances.back()[vertex];
+
+            if (forward != UNREACHABLE_WEIGHT && backward != UNREACHABLE_WEIGHT) {
+                cover_weights[vertex] = std::min(cover_weights[vertex], forward + backward);
+            }
+        }
+        cover_weights[landmark] = ZERO_WEIGHT;
+    }
+
+    data_.forward_distances.resize(vertex_count * landmark_count);
+    data_.backward_distances.resize(vertex_count * landmark_count);
+
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (size_t i = 0; i < landmark_count; ++i) {
+            data_.forward_distances[vertex * landmark_count + i] = forward_distances[i][vertex];
+            data_.backward_distances[vertex * landmark_count + i] = backward_distances[i][vertex];
+        }
+    }
+
+    reverse_offsets_.clear();
+    reverse_offsets_.shrink_to_fit();
+    reverse_edges_.clear();
+    reverse_edges_.shrink_to_fit();
+}
+
+template <typename Weight>
+std::vector<Weight> AltRouter<Weight>::ComputeDistances(VertexId source, bool reverse) const {
+    std::vector<Weight> weights(graph_.GetVertexCount(), UNREACHABLE_WEIGHT);
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    weights[source] = ZERO_WEIGHT;
+    queue.push({ ZERO_WEIGHT, source });
+
+    auto relax = [&](Weight weight, EdgeId edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const VertexId next = reverse ? edge.from : edge.to;
+        const Weight candidate_weight = weight + edge.weight;
+
+        if (candidate_weight < weights[next]) {
+            weights[next] = candidate_weight;
+            queue.push({ candidate_weight, next });
+        }
+    };
+
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+
+        if (weight > weights[vertex]) {
+            continue;
+        }
+
+        if (reverse) {
+            for (size_t i = reverse_offsets_[vertex]; i < reverse_offsets_[vertex + 1]; ++i) {
+                relax(weight, reverse_edges_[i]);
+            }
+        }
+        else {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(weight, edge_id);
+            }
+        }
+    }
+
+    return weights;
+}
+
+template <typename Weight>
+Weight AltRouter<Weight>::GetPotential(VertexId vertex, VertexId to) const {
+    const size_t landmark_count = data_.landmarks.size();
+    const Weight* forward_vertex = data_.forward_distances.data() + vertex * landmark_count;
+    const Weight* forward_to = data_.forward_distances.data() + to * landmark_count;
+    const Weight* backward_vertex = data_.backward_distances.data() + vertex * landmark_count;
+    const Weight* backward_to = data_.backward_distances.data() + to * landmark_count;
+    Weight result = ZERO_WEIGHT;
+
+    for (size_t i = 0; i < landmark_count; ++i) {
+        // d(v, t) >= d(L, t) - d(L, v); если ориентир достигает вершины, но не цели,
+        // то и из вершины цель недостижима
+        if (forward_vertex[i] != UNREACHABLE_WEIGHT) {
+            if (forward_to[i] == UNREACHABLE_WEIGHT) {
+                return UNREACHABLE_WEIGHT;
+            }
+            if (forward_to[i] > forward_vertex[i]) {
+                result = std::max(result, forward_to[i] - forward_vertex[i]);
+            }
+        }
+
+        // d(v, t) >= d(v, L) - d(t, L); если цель достигает ориентира, а вершина нет,
+        // то цель из вершины недостижима
+        if (backward_to[i] != UNREACHABLE_WEIGHT) {
+            if (backward_vertex[i] == UNREACHABLE_WEIGHT) {
+                return UNREACHABLE_WEIGHT;
+            }
+            if (backward_vertex[i] > backward_to[i]) {
+                result = std::max(result, backward_vertex[i] - backward_to[i]);
+            }
+        }
+    }
+
+    return result;
+}
+
+template <typename Weight>
+std::optional<typename AltRouter<Weight>::RouteInfo> AltRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+
+    ++query_count_;
+
+    std::vector<Weight> weights(vertex_count, UNREACHABLE_WEIGHT);
+    std::vector<EdgeId> prev_edges(vertex_count, NONE_EDGE);
+    size_t settled_vertex_count = 0;
+
+    // Элемент очереди: оценка полного пути через вершину, вес пути до неё и сама вершина
+    using QueueItem = std::tuple<Weight, Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    weights[from] = ZERO_WEIGHT;
+    if (const Weight potential = GetPotential(from, to); potential != UNREACHABLE_WEIGHT) {
+        queue.push({ potential, ZERO_WEIGHT, from });
+    }
+
+    while (!queue.empty()) {
+        const auto [estimate, weight, vertex] = queue.top();
+        queue.pop();
+
+        if (weight > weights[vertex]) {
+            continue;
+        }
+
+        ++settled_vertex_count;
+        if (vertex == to) {
+            break;
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+
+            if (candidate_weight < weights[edge.to]) {
+                const Weight potential = GetPotential(edge.to, to);
+
+                if (potential != UNREACHABLE_WEIGHT) {
+                    weights[edge.to] = candidate_weight;
+                    prev_edges[edge.to] = edge_id;
+                    queue.push({ candidate_weight + potential, candidate_weight, edge.to });
+                }
+            }
+        }
+    }
+
+    settled_vertex_count_ += settled_vertex_count;
+
+    if (weights[to] == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edges[to]; edge_id != NONE_EDGE; edge_id = prev_edges[graph_.GetEdge(edge_id).from]) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{ weights[to], std::move(edges) };
+}
+
+} // end of namespace graph
\ No newline at end of file
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Замер предрасчёта таблицы всех пар (make_base) при разном числе потоков.
+
+Пример:
+    python3 bench/bench_all_pairs.py build/transport_catalogue --size 35 --threads 1 2 4 8
+
+Сеть size x size даёт 2 * size^2 вершин графа. По умолчанию число потоков перебирается
+из 1, 2, 4 и количества ядер N; замер с одним потоком выполняется всегда. Для каждого
+числа потоков база строится repeat раз, выводятся наименьшее и медианное время
+и ускорение - отношение наименьшего времени с одним потоком к наименьшему времени
+с данным числом потоков. Таблица сохраняется в базе
+(store_routes_table), поэтому по каждой базе выполняются одни и те же запросы Route:
+при любом числе потоков ответы должны совпадать.
+"""
+
+import argparse
+import hashlib
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+from grid_network import write_grid
+
+
+def run_make_base(binary, make_path):
+    with open(make_path, "rb") as data:
+        start = time.perf_counter()
+        subprocess.run([binary, "make_base"], stdin=data, check=True)
+
+        return time.perf_counter() - start
+
+
+def answers_digest(binary, proc_path):
+    with open(proc_path, "rb") as data:
+        output = subprocess.run([binary, "process_requests"], stdin=data, stdout=subprocess.PIPE, check=True).stdout
+
+    return hashlib.sha256(output).hexdigest()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("binary", help="путь к transport_catalogue (сборка Release)")
+    parser.add_argument("--size", type=int, default=35, help="сторона решётки остановок")
+    parser.add_argument("--threads", type=int, nargs="+", help="значения thread_count (по умолчанию 1 2 4 N)")
+    parser.add_argument("--repeat", type=int, default=3, help="число повторов каждого замера")
+    args = parser.parse_args()
+
+    core_count = os.cpu_count() or 1
+    thread_counts = sorted(set(args.threads or [1, 2, 4, core_count]) | {1})
+    print(f"cores: {core_count}, grid: {args.size}x{args.size}, vertices: {2 * args.size ** 2}")
+    if max(thread_counts) > core_count:
+        print(f"warning: thread_count above {core_count} measures oversubscription, not parallel speedup")
+
+    digests = set()
+    single_thread_time = None
+    with tempfile.TemporaryDirectory() as directory:
+        for thread_count in thread_counts:
+            prefix = os.path.join(directory, f"threads_{thread_count}")
+            make_path, proc_path = write_grid(prefix, args.size, 200, {"routing_algorithm": "all_pairs",
+                                                                       "store_routes_table": True,
+                                                                       "thread_count": thread_count})
+            times = [run_make_base(args.binary, make_path) for _ in range(args.repeat)]
+            digests.add(answers_digest(args.binary, proc_path))
+            if thread_count == 1:
+                single_thread_time = min(times)
+            print(f"thread_count={thread_count}: min {min(times):.2f} s, median {statistics.median(times):.2f} s, "
+                  f"speedup {single_thread_time / min(times):.2f}x")
+
+    if len(digests) != 1:
+        print("error: answers differ between thread_count values")
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
\ No newline at end of file
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Замер запросов Route при нумерации вершин графа вдоль кривой Гильберта и без неё.
+
+Пример:
+    python3 bench/bench_hilbert.py build/transport_catalogue --size 100 --algorithms dijkstra alt
+
+Для каждого алгоритма база строится дважды - с hilbert_vertex_order и без него, -
+после чего замеряется process_requests на одних и тех же запросах с отключённым
+кэшем ответов. Выводятся наименьшее и медианное время из repeat повторов.
+Время маршрутов при обеих нумерациях должно совпадать: при равном времени
+могут различаться только выбранные рёбра.
+
+Ещё один запуск process_requests выполняется под `perf stat` со счётчиками промахов
+кэша (cache-misses и cache-references), по которым видно, уменьшает ли нумерация
+промахи. Без perf или без доступа к аппаратным счётчикам (perf_event_paranoid,
+виртуальная машина) вместо значений выводится причина.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+from grid_network import write_grid
+
+
+def run(binary, mode, input_path):
+    with open(input_path, "rb") as data:
+        start = time.perf_counter()
+        output = subprocess.run([binary, mode], stdin=data, stdout=subprocess.PIPE, check=True).stdout
+
+        return time.perf_counter() - start, output
+
+
+PERF_EVENTS = ("cache-misses", "cache-references")
+
+
+def run_perf_stat(perf, binary, input_path, output_path):
+    """Возвращает значения счётчиков PERF_EVENTS или строку с причиной их отсутствия."""
+    if shutil.which(perf) is None:
+        return f"{perf} not found"
+
+    command = [perf, "stat", "-x", ",", "-e", ",".join(PERF_EVENTS), "-o", output_path, "--", binary, "process_requests"]
+    with open(input_path, "rb") as data:
+        result = subprocess.run(command, stdin=data, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    if result.returncode != 0:
+        return result.stderr.decode(errors="replace").strip().splitlines()[-1] if result.stderr else "perf stat failed"
+
+    # Строки вывода -x: значение, единица, событие, ...; комментарии начинаются с #
+    counters = {}
+    with open(output_path) as stat:
+        for line in stat:
+            fields = line.strip().split(",")
+            if len(fields) < 3 or line.startswith("#"):
+                continue
+            event = fields[2].split(":")[0]
+            if event in PERF_EVENTS:
+                if not fields[0].isdigit():
+                    return f"{event} {fields[0]}"
+                counters[event] = int(fields[0])
+
+    if len(counters) != len(PERF_EVENTS):
+        return "no counters in perf output"
+
+    return counters
+
+
+def format_counters(counters):
+    if isinstance(counters, str):
+        return f"unavailable ({counters})"
+
+    misses = counters["cache-misses"]
+    references = counters["cache-references"]
+    share = f", {100.0 * misses / references:.1f}% of {references} references" if references else ""
+
+    return f"{misses}{share}"
+
+
+def route_times(output):
+    return [answer.get("total_time") for answer in json.loads(output)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("binary", help="путь к transport_catalogue (сборка Release)")
+    parser.add_argument("--size", type=int, default=100, help="сторона решётки остановок")
+    parser.add_argument("--routes", type=int, default=400, help="число запросов Route")
+    parser.add_argument("--algorithms", nargs="+", default=["dijkstra", "alt"], help="значения routing_algorithm")
+    parser.add_argument("--repeat", type=int, default=3, help="число повторов каждого замера")
+    parser.add_argument("--perf", default="perf", help="путь к perf для замера промахов кэша")
+    args = parser.parse_args()
+
+    print(f"grid: {args.size}x{args.size}, routes: {args.routes}")
+
+    is_consistent = True
+    with tempfile.TemporaryDirectory() as directory:
+        for algorithm in args.algorithms:
+            expected_times = None
+            for is_hilbert in (False, True):
+                prefix = os.path.join(directory, f"{algorithm}_{is_hilbert}")
+                make_path, proc_path = write_grid(prefix, args.size, args.routes, {"routing_algorithm": algorithm,
+                                                                                   "route_cache_size": 0,
+                                                                                   "hilbert_vertex_order": is_hilbert})
+                run(args.binary, "make_base", make_path)
+
+                times = []
+                for _ in range(args.repeat):
+                    elapsed, output = run(args.binary, "process_requests", proc_path)
+                    times.append(elapsed)
+
+                counters = run_perf_stat(args.perf, args.binary, proc_path, prefix + ".perf")
+
+                answers = route_times(output)
+                if expected_times is None:
+                    expected_times = answers
+                elif answers != expected_times:
+                    print(f"error: {algorithm} route times differ with hilbert_vertex_order")
+                    is_consistent = False
+
+                print(f"{algorithm}, hilbert_vertex_order={str(is_hilbert).lower()}: "
+                      f"min {min(times):.2f} s, median {statistics.median(times):.2f} s, "
+                      f"cache-misses {format_counters(counters)}")
+
+    return 0 if is_consistent else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
\ No newline at end of file
@@ -0,0 +1,79 @@
+"""Генератор сети для замеров производительности.
+
+Остановки стоят в узлах решётки size x size, маршруты идут вдоль строк и столбцов
+отрезками по 16 остановок с перекрытием в 8 остановок. Порядок остановок во входных
+данных перемешан, чтобы нумерация вершин графа не совпадала с расположением на карте.
+Сеть определяется размером и зерном, поэтому замеры воспроизводимы.
+"""
+
+import json
+import random
+
+BUS_LENGTH = 16
+
+RENDER_SETTINGS = {
+    "width": 1200, "height": 1200, "padding": 50,
+    "stop_radius": 5, "line_width": 14,
+    "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+    "stop_label_font_size": 20, "stop_label_offset": [7, -3],
+    "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+    "color_palette": ["green", [255, 160, 0], "red"],
+}
+
+
+def stop_name(row, column):
+    return f"S{row}_{column}"
+
+
+def make_base_requests(size, generator):
+    stops = []
+    for row in range(size):
+        for column in range(size):
+            distances = {}
+            if column + 1 < size:
+                distances[stop_name(row, column + 1)] = generator.randint(300, 700)
+            if row + 1 < size:
+                distances[stop_name(row + 1, column)] = generator.randint(300, 700)
+            stops.append({"type": "Stop", "name": stop_name(row, column),
+                          "latitude": 55 + row * 0.005, "longitude": 37 + column * 0.008,
+                          "road_distances": distances})
+    generator.shuffle(stops)
+
+    buses = []
+    for line in range(size):
+        for start in range(0, size - 1, BUS_LENGTH // 2):
+            end = min(size, start + BUS_LENGTH)
+            for route in ([stop_name(line, i) for i in range(start, end)],
+                          [stop_name(i, line) for i in range(start, end)]):
+                buses.append({"type": "Bus", "name": f"R{len(buses)}", "stops": route, "is_roundtrip": False})
+
+    return stops + buses
+
+
+def make_route_requests(size, count, generator):
+    def random_stop():
+        return stop_name(generator.randrange(size), generator.randrange(size))
+
+    return [{"id": i, "type": "Route", "from": random_stop(), "to": random_stop()} for i in range(count)]
+
+
+def write_grid(prefix, size, route_count, routing_settings, seed=7):
+    """Записывает входные данные make_base и process_requests в файлы prefix.make.json
+    и prefix.proc.json и возвращает их пути. База сохраняется в prefix.db"""
+    generator = random.Random(seed)
+    settings = {"bus_wait_time": 2, "bus_velocity": 30}
+    settings.update(routing_settings)
+    serialization = {"file": prefix + ".db"}
+
+    make_path = prefix + ".make.json"
+    with open(make_path, "w") as output:
+        json.dump({"serialization_settings": serialization, "routing_settings": settings,
+                   "render_settings": RENDER_SETTINGS,
+                   "base_requests": make_base_requests(size, generator)}, output)
+
+    proc_path = prefix + ".proc.json"
+    with open(proc_path, "w") as output:
+        json.dump({"serialization_settings": serialization,
+                   "stat_requests": make_route_requests(size, route_count, generator)}, output)
+
+    return make_path, proc_path
\ No newline at end of file
@@ -0,0 +1,489 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархия сокращений (Contraction Hierarchies).
+// При построении вершины стягиваются по одной, а кратчайшие пути через
+// стянутую вершину заменяются рёбрами-сокращениями. Запрос выполняется
+// двунаправленным поиском только вверх по иерархии, после чего сокращения
+// разворачиваются обратно в исходные рёбра графа
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    // Ребро-сокращение, заменяющее путь first -> second через стянутую вершину.
+    // Идентификаторы first/second меньше количества рёбер графа для исходных рёбер,
+    // остальные указывают на сокращение с номером (id - количество рёбер)
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first;
+        EdgeId second;
+    };
+
+    // Данные иерархии, сохраняемые в базе
+    struct Data {
+        // Порядковый номер стягивания каждой вершины
+        std::vector<size_t> ranks;
+        std::vector<Shortcut> shortcuts;
+    };
+
+    // Построение иерархии по графу
+    explicit ContractionHierarchy(const Graph& graph);
+
+    // Конструктор, принимающий готовую иерархию без повторного построения
+    ContractionHierarchy(const Graph& graph, Data data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    const Data& GetData() const {
+        return data_;
+    }
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NONE_EDGE = std::numeric_limits<EdgeId>::max();
+    // Ограничение числа вершин, просматриваемых при поиске альтернативного пути
+    static constexpr size_t WITNESS_SETTLED_LIMIT = 500;
+
+    struct Arc {
+        VertexId vertex;
+        Weight weight;
+        EdgeId id;
+    };
+
+    // Рабочий граф и очередь стягивания, нужные только при построении
+    class Contractor;
+
+    // Метка вершины при поиске: вес пути, дуга и соседняя вершина пути
+    struct Label {
+        Weight weight;
+        EdgeId arc;
+        VertexId vertex;
+    };
+    using Labels = std::unordered_map<VertexId, Label>;
+
+    void BuildSearchGraphs();
+
+    void UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const;
+
+    const Graph& graph_;
+    Data data_;
+    // Дуги, ведущие вверх по иерархии, для прямого поиска
+    std::vector<size_t> up_offsets_;
+    std::vector<Arc> up_arcs_;
+    // Входящие дуги из вершин с большим рангом для обратного поиска
+    std::vector<size_t> down_offsets_;
+    std::vector<Arc> down_arcs_;
+};
+
+template <typename Weight>
+class ContractionHierarchy<Weight>::Contractor {
+public:
+    Contractor(const Graph& graph, Data& data)
+        : edge_count_(graph.GetEdgeCount()), data_(data),
+          out_arcs_(graph.GetVertexCount()), in_arcs_(graph.GetVertexCount()),
+          contracted_(graph.GetVertexCount(), false), deleted_neighbours_(graph.GetVertexCount(), 0),
+          witness_weights_(graph.GetVertexCount(), INFINITE_WEIGHT)
+    {
+        // Из параллельных рёбер остаётся самое лёгкое, при равенстве - первое
+        for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                if (edge.from != edge.to) {
+                    SetArc(edge.from, edge.to, edge.weight, edge_id);
+                }
+            }
+        }
+    }
+
+    void Run() {
+        const size_t vertex_count = out_arcs_.size();
+        using QueueItem = std::pair<int, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            queue.push({ GetPriority(vertex), vertex });
+        }
+
+        data_.ranks.assign(vertex_count, 0);
+        size_t rank = 0;
+
+        while (!queue.empty()) {
+            const VertexId vertex = queue.top().second;
+            queue.pop();
+
+            // Ленивое обновление: приоритет пересчитывается перед стягиванием
+            const int priority = GetPriority(vertex);
+            if (!queue.empty() && priority > queue.top().first) {
+                queue.push({ priority, vertex });
+                continue;
+            }
+
+            Contract(vertex, false);
+            data_.ranks[vertex] = rank++;
+        }
+    }
+
+private:
+    void SetArc(VertexId from, VertexId to, Weight weight, EdgeId id) {
+        auto update = [](std::vector<Arc>& arcs, VertexId vertex, Weight weight, EdgeId id) {
+            for (Arc& arc : arcs) {
+                if (arc.vertex == vertex) {
+                    if (weight < arc.weight) {
+                        arc = { vertex, weight, id };
+                    }
+                    return;
+                }
+            }
+            arcs.push_back({ vertex, weight, id });
+        };
+
+        update(out_arcs_[from], to, weight, id);
+        update(in_arcs_[to], from, weight, id);
+    }
+
+    int GetPriority(VertexId vertex) {
+        int degree = 0;
+        for (const Arc& arc : in_arcs_[vertex]) {
+            degree += contracted_[arc.vertex] ? 0 : 1;
+        }
+        for (const Arc& arc : out_arcs_[vertex]) {
+            degree += contracted_[arc.vertex] ? 0 : 1;
+        }
+
+        return static_cast<int>(Contract(vertex, true)) - degree + deleted_neighbours_[vertex];
+    }
+
+    // Стягивание вершины; в режиме simulate только подсчитывается число сокращений
+    size_t Contract(VertexId vertex, bool simulate) {
+        size_t shortcut_count = 0;
+
+        for (const Arc in_arc : in_arcs_[vertex]) {
+            if (contracted_[in_arc.vertex]) {
+                continue;
+            }
+
+            Weight max_weight = ZERO_WEIGHT;
+            for (const Arc& out_arc : out_arcs_[vertex]) {
+                if (!contracted_[out_arc.vertex] && out_arc.vertex != in_arc.vertex) {
+                    max_weight = std::max(max_weight, in_arc.weight + out_arc.weight);
+                }
+            }
+
+            FindWitnesses(in_arc.vertex, vertex, max_weight);
+
+            // Новые сокращения не затрагивают списки дуг самой стягиваемой вершины
+            for (const Arc& out_arc : out_arcs_[vertex]) {
+                if (contracted_[out_arc.vertex] || out_arc.vertex == in_arc.vertex) {
+                    continue;
+                }
+
+                const Weight shortcut_weight = in_arc.weight + out_arc.weight;
+                if (witness_weights_[out_arc.vertex] <= shortcut_weight) {
+                    continue;
+                }
+
+                ++shortcut_count;
+                if (!simulate) {
+                    const EdgeId id = edge_count_ + data_.shortcuts.size();
+                    data_.shortcuts.push_back({ in_arc.vertex, out_arc.vertex, shortcut_weight, in_arc.id, out_arc.id });
+                    SetArc(in_arc.vertex, out_arc.vertex, shortcut_weight, id);
+                }
+            }
+
+            ResetWitnesses();
+        }
+
+        if (!simulate) {
+            contracted_[vertex] = true;
+            for (const Arc& arc : in_arcs_[vertex]) {
+                ++deleted_neighbours_[arc.vertex];
+            }
+            for (const Arc& arc : out_arcs_[vertex]) {
+                ++deleted_neighbours_[arc.vertex];
+            }
+        }
+
+        return shortcut_count;
+    }
+
+    // Ограниченный поиск путей из source в обход стягиваемой вершины
+    void FindWitnesses(VertexId source, VertexId excluded, Weight max_weight) {
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+        witness_weights_[source] = ZERO_WEIGHT;
+        touched_.push_back(source);
+        queue.push({ ZERO_WEIGHT, source });
+        size_t settled = 0;
+
+        while (!queue.empty() && settled < WITNESS_SETTLED_LIMIT) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+
+            if (weight > witness_weights_[vertex]) {
+                continue;
+            }
+            if (weight > max_weight) {
+                break;
+            }
+            ++settled;
+
+            for (const Arc& arc : out_arcs_[vertex]) {
+                if (arc.vertex == excluded || contracted_[arc.vertex]) {
+                    continue;
+                }
+
+                const Weight candidate_weight = weight + arc.weight;
+                if (candidate_weight < witness_weights_[arc.vertex]) {
+                    if (witness_weights_[arc.vertex] == INFINITE_WEIGHT) {
+                        touched_.push_back(arc.vertex);
+                    }
+                    witness_weights_[arc.vertex] = candidate_weight;
+                    queue.push({ candidate_weight, arc.vertex });
+                }
+            }
+        }
+    }
+
+    void ResetWitnesses() {
+        for (const VertexId vertex : touched_) {
+            witness_weights_[vertex] = INFINITE_WEIGHT;
+        }
+        touched_.clear();
+    }
+
+    size_t edge_count_;
+    Data& data_;
+    std::vector<std::vector<Arc>> out_arcs_;
+    std::vector<std::vector<Arc>> in_arcs_;
+    std::vector<bool> contracted_;
+    std::vector<int> deleted_neighbours_;
+    std::vector<Weight> witness_weights_;
+    std::vector<VertexId> touched_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph) : graph_(graph) {
+    Contractor(graph, data_).Run();
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, Data data)
+    : graph_(graph), data_(std::move(data))
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+
+    if (data_.ranks.size() != vertex_count) {
+        throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+    }
+
+    // Сокращение составлено из дуг, существовавших до его появления, поэтому номера
+    // его частей меньше его собственного номера; это исключает и выход за границы,
+    // и зацикливание при раскрытии сокращений
+    for (size_t i = 0; i < data_.shortcuts.size(); ++i) {
+        const Shortcut& shortcut = data_.shortcuts[i];
+        const size_t shortcut_id = edge_count + i;
+
+        if (shortcut.from >= vertex_count || shortcut.to >= vertex_count
+            || shortcut.first >= shortcut_id || shortcut.second >= shortcut_id)
+        {
+            throw std::invalid_argument("Contraction hierarchy shortcut is out of range");
+        }
+    }
+
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraphs() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t edge_count = graph_.GetEdgeCount();
+    std::vector<std::vector<Arc>> up_arcs(vertex_count);
+    std::vector<std::vector<Arc>> down_arcs(vertex_count);
+
+    auto add_arc = [&](VertexId from, VertexId to, Weight weight, EdgeId id) {
+        if (from == to) {
+            return;
+        }
+        if (data_.ranks[from] < data_.ranks[to]) {
+            up_arcs[from].push_back({ to, weight, id });
+        }
+        else {
+            down_arcs[to].push_back({ from, weight, id });
+        }
+    };
+
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        add_arc(edge.from, edge.to, edge.weight, edge_id);
+    }
+    for (size_t i = 0; i < data_.shortcuts.size(); ++i) {
+        const Shortcut& shortcut = data_.shortcuts[i];
+        add_arc(shortcut.from, shortcut.to, shortcut.weight, edge_count + i);
+    }
+
+    // Из параллельных дуг в поиске участвует только самая лёгкая
+    auto flatten = [vertex_count](std::vector<std::vector<Arc>>& arcs, std::vector<size_t>& offsets, std::vector<Arc>& result) {
+        offsets.assign(vertex_count + 1, 0);
+        result.clear();
+
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            auto& list = arcs[vertex];
+            std::stable_sort(list.begin(), list.end(), [](const Arc& lhs, const Arc& rhs) {
+                return std::tie(lhs.vertex, lhs.weight) < std::tie(rhs.vertex, rhs.weight);
+            });
+            list.erase(std::unique(list.begin(), list.end(), [](const Arc& lhs, const Arc& rhs) {
+                return lhs.vertex == rhs.vertex;
+            }), list.end());
+
+            result.insert(result.end(), list.begin(), list.end());
+            offsets[vertex + 1] = result.size();
+            std::vector<Arc>().swap(list);
+        }
+    };
+
+    flatten(up_arcs, up_offsets_, up_arcs_);
+    flatten(down_arcs, down_offsets_, down_arcs_);
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const {
+    const size_t edge_count = graph_.GetEdgeCount();
+    std::vector<EdgeId> stack{ arc_id };
+
+    while (!stack.empty()) {
+        const EdgeId id = stack.back();
+        stack.pop_back();
+
+        if (id < edge_count) {
+            edges.push_back(id);
+        }
+        else {
+            const Shortcut& shortcut = data_.shortcuts[id - edge_count];
+            stack.push_back(shortcut.second);
+            stack.push_back(shortcut.first);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ ZERO_WEIGHT, {} };
+    }
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    Labels forward_labels{ { from, { ZERO_WEIGHT, NONE_EDGE, from } } };
+    Labels backward_labels{ { to, { ZERO_WEIGHT, NONE_EDGE, to } } };
+    Queue forward_queue;
+    Queue backward_queue;
+    forward_queue.push({ ZERO_WEIGHT, from });
+    backward_queue.push({ ZERO_WEIGHT, to });
+
+    Weight best_weight = INFINITE_WEIGHT;
+    VertexId meeting_vertex = from;
+
+    // Шаг поиска в одном направлении по соответствующим дугам иерархии
+    auto step = [&](Queue& queue, Labels& labels, const Labels& opposite_labels,
+                    const std::vector<size_t>& offsets, const std::vector<Arc>& arcs) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+
+        if (weight > labels.at(vertex).weight) {
+            return;
+        }
+        if (const auto it = opposite_labels.find(vertex); it != opposite_labels.end()) {
+            if (weight + it->second.weight < best_weight) {
+                best_weight = weight + it->second.weight;
+                meeting_vertex = vertex;
+            }
+        }
+
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const Arc& arc = arcs[i];
+            const Weight candidate_weight = weight + arc.weight;
+            const auto it = labels.find(arc.vertex);
+
+            if (it == labels.end() || candidate_weight < it->second.weight) {
+                labels[arc.vertex] = { candidate_weight, arc.id, vertex };
+                queue.push({ candidate_weight, arc.vertex });
+            }
+        }
+    };
+
+    while (!forward_queue.empty() || !backward_queue.empty()) {
+        const Weight forward_min = forward_queue.empty() ? INFINITE_WEIGHT : forward_queue.top().first;
+        const Weight backward_min = backward_queue.empty() ? INFINITE_WEIGHT : backward_queue.top().first;
+
+        // Оба фронта не могут улучшить найденный путь
+        if (std::min(forward_min, backward_min) >= best_weight) {
+            break;
+        }
+
+        if (forward_min <= backward_min) {
+            step(forward_queue, forward_labels, backward_labels, up_offsets_, up_arcs_);
+        }
+        else {
+            step(backward_queue, backward_labels, forward_labels, down_offsets_, down_arcs_);
+        }
+    }
+
+    if (best_weight == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    // Дуги от начала до точки встречи собираются в обратном порядке
+    std::vector<EdgeId> forward_arcs;
+    for (VertexId vertex = meeting_vertex; vertex != from;) {
+        const Label& label = forward_labels.at(vertex);
+        forward_arcs.push_back(label.arc);
+        vertex = label.vertex;
+    }
+
+    std::vector<EdgeId> edges;
+    for (auto it = forward_arcs.rbegin(); it != forward_arcs.rend(); ++it) {
+        UnpackArc(*it, edges);
+    }
+    for (VertexId vertex = meeting_vertex; vertex != to;) {
+        const Label& label = backward_labels.at(vertex);
+        UnpackArc(label.arc, edges);
+        vertex = label.vertex;
+    }
+
+    return RouteInfo{ best_weight, std::move(edges) };
+}
+
+} // end of namespace graph
\ No newline at end of file
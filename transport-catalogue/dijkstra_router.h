@@ -0,0 +1,358 @@
+#pragma once
+
+#include "graph.h"
+#include "lru_cache.h"
+#include "radix_heap.h"
+#include "router.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор, строящий кратчайшие пути по запросу алгоритмом Дейкстры.
+// Вместо таблицы V×V хранит ограниченное число последних деревьев
+// кратчайших путей, ключом которых служит исходная вершина
+template <typename Weight>
+class DijkstraRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    static constexpr size_t DEFAULT_CACHE_SIZE = 64;
+
+    explicit DijkstraRouter(const Graph& graph, size_t cache_size = DEFAULT_CACHE_SIZE);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    // Маршруты от одной вершины до нескольких по одному дереву кратчайших путей
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& to) const;
+
+    // Сброс кэша деревьев после изменения графа
+    void ClearCache() {
+        std::lock_guard guard(cache_mutex_);
+        trees_ = cache::LruCache<VertexId, std::shared_ptr<const ShortestPathTree>>(trees_.GetCapacity());
+    }
+
+    // Вершины учитываются только при построении деревьев, запросы из кэша их не добавляют
+    SearchStats GetStats() const {
+        return { query_count_.load(), settled_vertex_count_.load() };
+    }
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NONE_EDGE = std::numeric_limits<EdgeId>::max();
+
+    // Дерево кратчайших путей от одной вершины
+    struct ShortestPathTree {
+        std::vector<Weight> weights;
+        std::vector<EdgeId> prev_edges;
+    };
+
+    std::shared_ptr<const ShortestPathTree> GetShortestPathTree(VertexId from) const;
+
+    std::optional<RouteInfo> BuildRoute(const ShortestPathTree& tree, VertexId to) const;
+
+    ShortestPathTree BuildShortestPathTree(VertexId from) const;
+
+    const Graph& graph_;
+    mutable std::mutex cache_mutex_;
+    mutable cache::LruCache<VertexId, std::shared_ptr<const ShortestPathTree>> trees_;
+
+    mutable std::atomic<size_t> query_count_ = 0;
+    mutable std::atomic<size_t> settled_vertex_count_ = 0;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, size_t cache_size)
+    : graph_(graph), trees_(cache_size)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    ++query_count_;
+
+    return BuildRoute(*GetShortestPathTree(from), to);
+}
+
+template <typename Weight>
+std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>>
+DijkstraRouter<Weight>::BuildRoutes(VertexId from, const std::vector<VertexId>& to) const {
+    query_count_ += to.size();
+
+    const auto tree = GetShortestPathTree(from);
+    std::vector<std::optional<RouteInfo>> result;
+    result.reserve(to.size());
+
+    for (const VertexId vertex : to) {
+        result.push_back(BuildRoute(*tree, vertex));
+    }
+
+    return result;
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::BuildRoute(const ShortestPathTree& tree, VertexId to) const {
+    const Weight weight = tree.weights.at(to);
+
+    if (weight == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = tree.prev_edges[to]; edge_id != NONE_EDGE;
+         edge_id = tree.prev_edges[graph_.GetEdge(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::shared_ptr<const typename DijkstraRouter<Weight>::ShortestPathTree>
+DijkstraRouter<Weight>::GetShortestPathTree(VertexId from) const {
+    {
+        std::lock_guard guard(cache_mutex_);
+        if (auto tree = trees_.Get(from)) {
+            return *tree;
+        }
+    }
+
+    // Дерево строится вне блокировки, чтобы не задерживать остальные запросы
+    auto tree = std::make_shared<const ShortestPathTree>(BuildShortestPathTree(from));
+
+    std::lock_guard guard(cache_mutex_);
+    trees_.Put(from, tree);
+
+    return tree;
+}
+
+template <typename Weight>
+typename DijkstraRouter<Weight>::ShortestPathTree DijkstraRouter<Weight>::BuildShortestPathTree(VertexId from) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    ShortestPathTree tree{ std::vector<Weight>(vertex_count, UNREACHABLE_WEIGHT),
+                           std::vector<EdgeId>(vertex_count, NONE_EDGE) };
+
+    DijkstraQueue<Weight, VertexId> queue;
+    size_t settled_vertex_count = 0;
+
+    tree.weights.at(from) = ZERO_WEIGHT;
+    queue.Push(ZERO_WEIGHT, from);
+
+    while (!queue.IsEmpty()) {
+        const auto [weight, vertex] = queue.Pop();
+
+        // Устаревшая запись очереди: вершина уже достигнута быстрее
+        if (weight > tree.weights[vertex]) {
+            continue;
+        }
+        ++settled_vertex_count;
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+
+            if (candidate_weight < tree.weights[edge.to]) {
+                tree.weights[edge.to] = candidate_weight;
+                tree.prev_edges[edge.to] = edge_id;
+                queue.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+    settled_vertex_count_ += settled_vertex_count;
+
+    return tree;
+}
+
+// Поиск Дейкстры от одной вершины до набора целей.
+// Рабочие массивы сохраняются между поисками и сбрасываются только в затронутых
+// вершинах, а поиск прекращается, как только обработаны все цели
+template <typename Weight>
+class OneToManySearch {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    explicit OneToManySearch(const Graph& graph);
+
+    // Веса кратчайших путей от from до каждой из вершин targets
+    void Run(VertexId from, const std::vector<VertexId>& targets, std::vector<std::optional<Weight>>& weights);
+
+    // Вершины, вес пути до которых от from не больше max_weight, в порядке неубывания веса.
+    // Поиск останавливается, как только вес очередной вершины превышает ограничение,
+    // поэтому просматривается только достижимая за это время часть графа
+    void RunBounded(VertexId from, Weight max_weight, std::vector<std::pair<VertexId, Weight>>& reached);
+
+    // Маршрут до одной из целей последнего поиска
+    std::optional<RouteInfo> BuildRoute(VertexId to) const;
+
+private:
+    // Сброс рабочих массивов в затронутых прошлым поиском вершинах и начало поиска от from
+    void Start(VertexId from);
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NONE_EDGE = std::numeric_limits<EdgeId>::max();
+
+    const Graph& graph_;
+    std::vector<Weight> weights_;
+    std::vector<EdgeId> prev_edges_;
+    std::vector<bool> is_target_;
+    std::vector<VertexId> touched_;
+    DijkstraQueue<Weight, VertexId> queue_;
+};
+
+template <typename Weight>
+OneToManySearch<Weight>::OneToManySearch(const Graph& graph)
+    : graph_(graph), weights_(graph.GetVertexCount(), UNREACHABLE_WEIGHT),
+      prev_edges_(graph.GetVertexCount(), NONE_EDGE), is_target_(graph.GetVertexCount(), false) {}
+
+template <typename Weight>
+void OneToManySearch<Weight>::Run(VertexId from, const std::vector<VertexId>& targets,
+                                  std::vector<std::optional<Weight>>& weights)
+{
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+
+    Start(from);
+
+    size_t remaining_targets = 0;
+    for (const VertexId target : targets) {
+        if (target >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        if (!is_target_[target]) {
+            is_target_[target] = true;
+            ++remaining_targets;
+        }
+    }
+
+    while (!queue_.IsEmpty() && remaining_targets > 0) {
+        const auto [weight, vertex] = queue_.Pop();
+
+        if (weight > weights_[vertex]) {
+            continue;
+        }
+        if (is_target_[vertex]) {
+            is_target_[vertex] = false;
+            --remaining_targets;
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+
+            if (candidate_weight < weights_[edge.to]) {
+                if (weights_[edge.to] == UNREACHABLE_WEIGHT) {
+                    touched_.push_back(edge.to);
+                }
+                weights_[edge.to] = candidate_weight;
+                prev_edges_[edge.to] = edge_id;
+                queue_.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+
+    weights.assign(targets.size(), std::nullopt);
+    for (size_t i = 0; i < targets.size(); ++i) {
+        is_target_[targets[i]] = false;
+
+        if (weights_[targets[i]] != UNREACHABLE_WEIGHT) {
+            weights[i] = weights_[targets[i]];
+        }
+    }
+}
+
+template <typename Weight>
+void OneToManySearch<Weight>::RunBounded(VertexId from, Weight max_weight, std::vector<std::pair<VertexId, Weight>>& reached) {
+    if (from >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+
+    Start(from);
+    reached.clear();
+
+    while (!queue_.IsEmpty()) {
+        const auto [weight, vertex] = queue_.Pop();
+
+        if (weight > weights_[vertex]) {
+            continue;
+        }
+        if (weight > max_weight) {
+            break;
+        }
+        reached.emplace_back(vertex, weight);
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+
+            // Вершины за пределами ограничения в очередь не добавляются
+            if (candidate_weight <= max_weight && candidate_weight < weights_[edge.to]) {
+                if (weights_[edge.to] == UNREACHABLE_WEIGHT) {
+                    touched_.push_back(edge.to);
+                }
+                weights_[edge.to] = candidate_weight;
+                prev_edges_[edge.to] = edge_id;
+                queue_.Push(candidate_weight, edge.to);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void OneToManySearch<Weight>::Start(VertexId from) {
+    for (const VertexId vertex : touched_) {
+        weights_[vertex] = UNREACHABLE_WEIGHT;
+        prev_edges_[vertex] = NONE_EDGE;
+    }
+    touched_.clear();
+
+    queue_.Clear();
+    weights_[from] = ZERO_WEIGHT;
+    touched_.push_back(from);
+    queue_.Push(ZERO_WEIGHT, from);
+}
+
+template <typename Weight>
+std::optional<typename OneToManySearch<Weight>::RouteInfo> OneToManySearch<Weight>::BuildRoute(VertexId to) const {
+    const Weight weight = weights_.at(to);
+
+    if (weight == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edges_[to]; edge_id != NONE_EDGE; edge_id = prev_edges_[graph_.GetEdge(edge_id).from]) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{ weight, std::move(edges) };
+}
+
+} // end of namespace graph
\ No newline at end of file
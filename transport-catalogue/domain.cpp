@@ -5,7 +5,7 @@ namespace transport {
 Stop::Stop(const std::string& title, const geo::Coordinates& coordinates)
     : stop_title(title), coords(coordinates) {}
 
-int Stop::GetStopsDistance(Stop* next) {
+int Stop::GetStopsDistance(const Stop* next) const {
     if (stops_distances.count(next->stop_title)) {
         return stops_distances.at(next->stop_title);
     }
@@ -10,6 +10,8 @@
 namespace transport {
 
 struct Stop {
+    // Порядковый номер остановки в каталоге
+    size_t id = 0;
     // Название остановки
     std::string stop_title;
     // Координаты остановки
@@ -19,10 +21,12 @@ struct Stop {
     
     Stop(const std::string& title, const geo::Coordinates& coordinates);
     // Получение информации о расстоянии между остановками
-    int GetStopsDistance(Stop* next);
+    int GetStopsDistance(const Stop* next) const;
 };
 
 struct Bus {
+    // Порядковый номер маршрута в каталоге
+    size_t id = 0;
     // Номер автобуса/маршрута
     std::string bus_number;
     // Список остановок на маршруте
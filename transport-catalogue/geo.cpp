@@ -1,7 +1,9 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 namespace geo {
 
@@ -18,4 +20,76 @@ double ComputeDistance(Coordinates from, Coordinates to) {
                 std::cos(std::abs(from.lng - to.lng) * dr)) * earth_radius;
 }
 
+namespace {
+
+// Количество уровней кривой: сетка 2^16 x 2^16 ячеек
+constexpr int HILBERT_LEVELS = 16;
+constexpr uint32_t HILBERT_SIDE = 1u << HILBERT_LEVELS;
+
+// Номер ячейки (x, y) вдоль кривой Гильберта
+uint64_t GetHilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t result = 0;
+    
+    for (uint32_t side = HILBERT_SIDE / 2; side > 0; side /= 2) {
+        const uint32_t rx = (x & side) ? 1 : 0;
+        const uint32_t ry = (y & side) ? 1 : 0;
+        result += static_cast<uint64_t>(side) * side * ((3 * rx) ^ ry);
+        
+        // Поворот четверти, чтобы кривая внутри неё шла в нужном направлении
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - (x & (side - 1));
+                y = side - 1 - (y & (side - 1));
+            }
+            std::swap(x, y);
+        }
+    }
+    
+    return result;
+}
+
+// Положение координаты в сетке кривой на отрезке [min_value, max_value]
+uint32_t GetHilbertCell(double value, double min_value, double max_value) {
+    if (max_value <= min_value) {
+        return 0;
+    }
+    
+    const double cell = (value - min_value) / (max_value - min_value) * (HILBERT_SIDE - 1);
+    return static_cast<uint32_t>(std::clamp(cell, 0.0, static_cast<double>(HILBERT_SIDE - 1)));
+}
+
+} // end of namespace
+
+std::vector<size_t> ComputeHilbertOrder(const std::vector<Coordinates>& points) {
+    std::vector<size_t> result(points.size());
+    if (points.empty()) {
+        return result;
+    }
+    
+    double min_lat = points.front().lat;
+    double max_lat = points.front().lat;
+    double min_lng = points.front().lng;
+    double max_lng = points.front().lng;
+    
+    for (const Coordinates& point : points) {
+        min_lat = std::min(min_lat, point.lat);
+        max_lat = std::max(max_lat, point.lat);
+        min_lng = std::min(min_lng, point.lng);
+        max_lng = std::max(max_lng, point.lng);
+    }
+    
+    std::vector<uint64_t> indices(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        indices[i] = GetHilbertIndex(GetHilbertCell(points[i].lng, min_lng, max_lng),
+                                     GetHilbertCell(points[i].lat, min_lat, max_lat));
+        result[i] = i;
+    }
+    
+    std::stable_sort(result.begin(), result.end(), [&indices](size_t lhs, size_t rhs) {
+        return indices[lhs] < indices[rhs];
+    });
+    
+    return result;
+}
+
 } // end of namespace geo
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace geo {
 
 struct Coordinates {
@@ -17,4 +20,9 @@ struct Coordinates {
 
 double ComputeDistance(Coordinates from, Coordinates to);
 
+// Возвращает номера точек в порядке обхода кривой Гильберта, построенной
+// в охватывающем точки прямоугольнике. Близкие точки получают близкие места
+// в порядке; точки в одной ячейке кривой сохраняют исходный порядок
+std::vector<size_t> ComputeHilbertOrder(const std::vector<Coordinates>& points);
+
 } // end of namespace geo
\ No newline at end of file
@@ -3,73 +3,253 @@
 #include "ranges.h"
 
 #include <utility>
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <vector>
-#include <string>
 
 namespace graph {
 
-using VertexId = size_t;
+using VertexId = uint32_t;
 using EdgeId = size_t;
 
+// Ребро графа. Вместо названия хранится номер объекта, которому принадлежит
+// ребро (например, остановки или маршрута), что делает ребро компактным
 template <typename Weight>
 struct Edge {
-    std::string name;
-    size_t quality;
+    uint32_t item_id;
+    uint32_t quality;
     VertexId from;
     VertexId to;
     Weight weight;
 };
 
+// Ориентированный взвешенный граф.
+// При построении рёбра добавляются в списки смежности вершин, после чего граф
+// "замораживается" в компактную форму CSR: массив смещений по вершинам и общий
+// массив номеров рёбер, упорядоченных по начальной вершине
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<const EdgeId*>;
 
 public:
+    // Номер удалённого ребра в нумерации, возвращаемой RemoveEdges
+    static constexpr EdgeId REMOVED_EDGE = std::numeric_limits<EdgeId>::max();
+
     DirectedWeightedGraph() = default;
-    
+
     explicit DirectedWeightedGraph(size_t vertex_count);
-    
-    explicit DirectedWeightedGraph(std::vector<Edge<Weight>> edges, std::vector<std::vector<EdgeId>> incidence_lists);
-    
+
+    // Создание замороженного графа из списка рёбер за линейное время.
+    // Порядок рёбер каждой вершины совпадает с порядком их добавления через AddEdge
+    explicit DirectedWeightedGraph(size_t vertex_count, std::vector<Edge<Weight>> edges);
+
+    // Создание замороженного графа из готового представления CSR
+    explicit DirectedWeightedGraph(std::vector<Edge<Weight>> edges, std::vector<size_t> incident_edges_offsets,
+                                   std::vector<EdgeId> incident_edges);
+
+    // Добавление ребра; замороженный граф при этом возвращается к спискам смежности
     EdgeId AddEdge(Edge<Weight>&& edge);
 
+    // Удаление рёбер с сохранением порядка остальных. Номера оставшихся рёбер
+    // сдвигаются; возвращается новый номер каждого прежнего ребра или REMOVED_EDGE
+    std::vector<EdgeId> RemoveEdges(const std::vector<EdgeId>& edge_ids);
+
+    // Перевод графа в форму CSR, после которой обход не требует проверок границ
+    void Freeze();
+
+    bool IsFrozen() const;
+
     size_t GetVertexCount() const;
-    
+
     size_t GetEdgeCount() const;
-    
+
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
-    
+
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    const std::vector<size_t>& GetIncidentEdgesOffsets() const;
+
+    const std::vector<EdgeId>& GetIncidentEdges() const;
+
 private:
+    void Thaw();
+
+    size_t vertex_count_ = 0;
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+
+    // Представление CSR: рёбра вершины v занимают диапазон
+    // [incident_edges_offsets_[v], incident_edges_offsets_[v + 1]) массива incident_edges_
+    bool frozen_ = false;
+    std::vector<size_t> incident_edges_offsets_;
+    std::vector<EdgeId> incident_edges_;
 };
 
 template <typename Weight>
-DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count) : incidence_lists_(vertex_count) {}
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
+    : vertex_count_(vertex_count), incidence_lists_(vertex_count) {}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count, std::vector<Edge<Weight>> edges)
+    : vertex_count_(vertex_count), edges_(std::move(edges)), frozen_(true),
+      incident_edges_offsets_(vertex_count + 1, 0), incident_edges_(edges_.size())
+{
+    // Сортировка подсчётом номеров рёбер по начальной вершине
+    for (const Edge<Weight>& edge : edges_) {
+        if (edge.from >= vertex_count_) {
+            throw std::out_of_range("Edge's vertex is out of range");
+        }
+        ++incident_edges_offsets_[edge.from + 1];
+    }
+    for (size_t i = 0; i < vertex_count_; ++i) {
+        incident_edges_offsets_[i + 1] += incident_edges_offsets_[i];
+    }
+
+    std::vector<size_t> positions(incident_edges_offsets_.begin(), incident_edges_offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        incident_edges_[positions[edges_[edge_id].from]++] = edge_id;
+    }
+}
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(
-    std::vector<Edge<Weight>> edges, std::vector<std::vector<EdgeId>> incidence_lists)
-    : edges_(edges), incidence_lists_(incidence_lists) {}
+    std::vector<Edge<Weight>> edges, std::vector<size_t> incident_edges_offsets, std::vector<EdgeId> incident_edges)
+    : vertex_count_(incident_edges_offsets.empty() ? 0 : incident_edges_offsets.size() - 1),
+      edges_(std::move(edges)), frozen_(true),
+      incident_edges_offsets_(std::move(incident_edges_offsets)), incident_edges_(std::move(incident_edges))
+{
+    if (incident_edges_offsets_.empty()) {
+        incident_edges_offsets_.push_back(0);
+    }
+
+    for (size_t i = 0; i < vertex_count_; ++i) {
+        if (incident_edges_offsets_[i] > incident_edges_offsets_[i + 1]) {
+            throw std::invalid_argument("Incident edges offsets should be non-decreasing");
+        }
+    }
+    if (incident_edges_offsets_.front() != 0 || incident_edges_offsets_.back() != incident_edges_.size()) {
+        throw std::invalid_argument("Incident edges offsets don't match incident edges");
+    }
+    for (const EdgeId edge_id : incident_edges_) {
+        if (edge_id >= edges_.size()) {
+            throw std::invalid_argument("Incident edge id is out of range");
+        }
+    }
+}
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(Edge<Weight>&& edge) {
+    Thaw();
     edges_.push_back(std::move(edge));
-    
+
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edges_.back().from).push_back(id);
-    
+
     return id;
 }
 
+template <typename Weight>
+std::vector<EdgeId> DirectedWeightedGraph<Weight>::RemoveEdges(const std::vector<EdgeId>& edge_ids) {
+    std::vector<EdgeId> new_edge_ids(edges_.size(), 0);
+
+    for (const EdgeId edge_id : edge_ids) {
+        if (edge_id >= edges_.size()) {
+            throw std::out_of_range("Edge id is out of range");
+        }
+        new_edge_ids[edge_id] = REMOVED_EDGE;
+    }
+
+    EdgeId edge_count = 0;
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        if (new_edge_ids[edge_id] != REMOVED_EDGE) {
+            new_edge_ids[edge_id] = edge_count;
+            edges_[edge_count++] = edges_[edge_id];
+        }
+    }
+    edges_.resize(edge_count);
+
+    // Рёбра вершин перенумеровываются, относительный порядок рёбер вершины сохраняется
+    if (frozen_) {
+        std::vector<size_t> offsets(vertex_count_ + 1, 0);
+        size_t count = 0;
+
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            for (size_t i = incident_edges_offsets_[vertex]; i < incident_edges_offsets_[vertex + 1]; ++i) {
+                if (new_edge_ids[incident_edges_[i]] != REMOVED_EDGE) {
+                    incident_edges_[count++] = new_edge_ids[incident_edges_[i]];
+                }
+            }
+            offsets[vertex + 1] = count;
+        }
+        incident_edges_.resize(count);
+        incident_edges_offsets_ = std::move(offsets);
+    }
+    else {
+        for (IncidenceList& incidence_list : incidence_lists_) {
+            size_t count = 0;
+            for (const EdgeId edge_id : incidence_list) {
+                if (new_edge_ids[edge_id] != REMOVED_EDGE) {
+                    incidence_list[count++] = new_edge_ids[edge_id];
+                }
+            }
+            incidence_list.resize(count);
+        }
+    }
+
+    return new_edge_ids;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (frozen_) {
+        return;
+    }
+
+    incident_edges_offsets_.assign(vertex_count_ + 1, 0);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        incident_edges_offsets_[vertex + 1] = incident_edges_offsets_[vertex] + incidence_lists_[vertex].size();
+    }
+
+    incident_edges_.clear();
+    incident_edges_.reserve(incident_edges_offsets_.back());
+    for (const IncidenceList& incidence_list : incidence_lists_) {
+        incident_edges_.insert(incident_edges_.end(), incidence_list.begin(), incidence_list.end());
+    }
+
+    incidence_lists_.clear();
+    incidence_lists_.shrink_to_fit();
+    frozen_ = true;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Thaw() {
+    if (!frozen_) {
+        return;
+    }
+
+    incidence_lists_.assign(vertex_count_, {});
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        incidence_lists_[vertex].assign(incident_edges_.begin() + incident_edges_offsets_[vertex],
+                                        incident_edges_.begin() + incident_edges_offsets_[vertex + 1]);
+    }
+
+    incident_edges_offsets_.clear();
+    incident_edges_.clear();
+    frozen_ = false;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return frozen_;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
@@ -79,13 +259,92 @@ size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
 
 template <typename Weight>
 const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+    return edges_[edge_id];
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    if (frozen_) {
+        const EdgeId* incident_edges = incident_edges_.data();
+        return { incident_edges + incident_edges_offsets_[vertex], incident_edges + incident_edges_offsets_[vertex + 1] };
+    }
+
+    const IncidenceList& incidence_list = incidence_lists_.at(vertex);
+    return { incidence_list.data(), incidence_list.data() + incidence_list.size() };
+}
+
+template <typename Weight>
+const std::vector<size_t>& DirectedWeightedGraph<Weight>::GetIncidentEdgesOffsets() const {
+    return incident_edges_offsets_;
+}
+
+template <typename Weight>
+const std::vector<EdgeId>& DirectedWeightedGraph<Weight>::GetIncidentEdges() const {
+    return incident_edges_;
+}
+
+// Удаление из списка рёбер параллельных рёбер, доминируемых другими рёбрами с теми же
+// концами. Для каждой пары вершин остаётся ребро с наименьшим весом, а из рёбер
+// с равным весом - первое в списке: его же выбирает поиск по графу из полного списка,
+// так как рёбра вершины обходятся в порядке номеров и заменяются только более лёгкими.
+// Порядок оставшихся рёбер сохраняется. Возвращает количество удалённых рёбер
+template <typename Weight>
+size_t RemoveDominatedEdges(std::vector<Edge<Weight>>& edges, size_t vertex_count) {
+    static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    // Номера рёбер, сгруппированные по начальной вершине в порядке списка
+    std::vector<size_t> offsets(vertex_count + 1, 0);
+    for (const Edge<Weight>& edge : edges) {
+        if (edge.from >= vertex_count || edge.to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        ++offsets[edge.from + 1];
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets[vertex + 1] += offsets[vertex];
+    }
+
+    std::vector<size_t> edge_ids(edges.size());
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    for (size_t edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        edge_ids[positions[edges[edge_id].from]++] = edge_id;
+    }
+
+    // Лучшее ребро до каждой вершины среди рёбер текущей начальной вершины
+    std::vector<size_t> best_edges(vertex_count, NONE);
+    std::vector<bool> is_kept(edges.size(), false);
+
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const Edge<Weight>& edge = edges[edge_ids[i]];
+            size_t& best_edge = best_edges[edge.to];
+
+            if (best_edge == NONE || edge.weight < edges[best_edge].weight) {
+                best_edge = edge_ids[i];
+            }
+        }
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            size_t& best_edge = best_edges[edges[edge_ids[i]].to];
+
+            if (best_edge != NONE) {
+                is_kept[best_edge] = true;
+                best_edge = NONE;
+            }
+        }
+    }
+
+    size_t kept_count = 0;
+    for (size_t edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        if (is_kept[edge_id]) {
+            edges[kept_count++] = std::move(edges[edge_id]);
+        }
+    }
+
+    const size_t removed_count = edges.size() - kept_count;
+    edges.resize(kept_count);
+
+    return removed_count;
 }
 
 } // end of namespace graph
\ No newline at end of file
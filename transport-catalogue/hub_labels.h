@@ -0,0 +1,450 @@
+#pragma once
+
+#include "graph.h"
+#include "radix_heap.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Оракул расстояний на метках хабов (hub labeling). Каждой вершине сопоставляются
+// прямая метка - хабы, достижимые из вершины, с весами путей до них, и обратная -
+// хабы, из которых достижима вершина. Кратчайший путь проходит через общий хаб
+// прямой метки начала и обратной метки конца, поэтому вес пути находится слиянием
+// двух отсортированных меток без поиска по графу.
+// Метки строятся отсечённым поиском Дейкстры (pruned landmark labeling) от вершин
+// в порядке убывания важности: вершина не получает хаб, если путь до неё уже
+// покрыт метками ранее обработанных хабов
+template <typename Weight>
+class HubLabels {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    // Элемент метки: ранг хаба, ребро пути, смежное с вершиной метки, и вес пути.
+    // В прямой метке это первое ребро пути от вершины к хабу, в обратной -
+    // последнее ребро пути от хаба к вершине. По этим рёбрам восстанавливается путь
+    struct LabelEntry {
+        uint32_t hub;
+        EdgeId edge;
+        Weight weight;
+    };
+
+    // Данные меток, сохраняемые в базе. Метки всех вершин упакованы в общие массивы
+    // и отсортированы по рангу хаба: метка вершины v занимает позиции
+    // с offsets[v] до offsets[v + 1]
+    struct Data {
+        // Вершины в порядке убывания важности; ранг хаба - позиция в этом массиве
+        std::vector<VertexId> hubs;
+        std::vector<size_t> forward_offsets;
+        std::vector<LabelEntry> forward_labels;
+        std::vector<size_t> backward_offsets;
+        std::vector<LabelEntry> backward_labels;
+    };
+
+    // Количество деревьев кратчайших путей, по которым оценивается важность вершин
+    static constexpr size_t DEFAULT_SAMPLE_COUNT = 64;
+
+    // Построение меток по графу с порядком вершин по покрытию кратчайших путей
+    explicit HubLabels(const Graph& graph, size_t sample_count = DEFAULT_SAMPLE_COUNT);
+
+    // Построение меток с заданным порядком вершин по убыванию важности
+    HubLabels(const Graph& graph, std::vector<VertexId> hubs);
+
+    // Конструктор, принимающий готовые метки без повторного построения
+    HubLabels(const Graph& graph, Data data);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    // Вес кратчайшего пути слиянием меток без восстановления рёбер
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+
+    const Data& GetData() const {
+        return data_;
+    }
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NONE_EDGE = std::numeric_limits<EdgeId>::max();
+    static constexpr uint32_t NONE_HUB = std::numeric_limits<uint32_t>::max();
+
+    using Labels = std::vector<std::vector<LabelEntry>>;
+
+    // Общий хаб меток с наименьшим весом пути через него
+    struct Meeting {
+        uint32_t hub = NONE_HUB;
+        Weight weight = UNREACHABLE_WEIGHT;
+    };
+
+    static std::vector<VertexId> OrderByCoverage(const Graph& graph, size_t sample_count);
+
+    void BuildLabels();
+
+    // Отсечённый поиск от хаба с рангом rank по исходящим рёбрам (reverse = false),
+    // пополняющий обратные метки, или по входящим рёбрам, пополняющий прямые
+    void RunPrunedSearch(uint32_t rank, bool reverse, const std::vector<size_t>& reverse_offsets,
+                         const std::vector<EdgeId>& reverse_edges, Labels& forward, Labels& backward,
+                         std::vector<Weight>& weights, std::vector<EdgeId>& edges,
+                         std::vector<Weight>& hub_weights, DijkstraQueue<Weight, VertexId>& queue) const;
+
+    static void PackLabels(Labels& labels, std::vector<size_t>& offsets, std::vector<LabelEntry>& packed);
+
+    Meeting FindMeeting(VertexId from, VertexId to) const;
+
+    // Элемент метки вершины для хаба с заданным рангом
+    static const LabelEntry& FindEntry(const std::vector<size_t>& offsets, const std::vector<LabelEntry>& labels,
+                                       VertexId vertex, uint32_t hub);
+
+    const Graph& graph_;
+    Data data_;
+};
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const Graph& graph, size_t sample_count)
+    : HubLabels(graph, OrderByCoverage(graph, sample_count)) {}
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const Graph& graph, std::vector<VertexId> hubs) : graph_(graph) {
+    if (hubs.size() != graph.GetVertexCount()) {
+        throw std::invalid_argument("Hubs order should contain every vertex");
+    }
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    data_.hubs = std::move(hubs);
+    BuildLabels();
+}
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const Graph& graph, Data data) : graph_(graph), data_(std::move(data)) {
+    const size_t vertex_count = graph.GetVertexCount();
+
+    if (data_.hubs.size() != vertex_count
+        || data_.forward_offsets.size() != vertex_count + 1 || data_.forward_offsets.back() != data_.forward_labels.size()
+        || data_.backward_offsets.size() != vertex_count + 1 || data_.backward_offsets.back() != data_.backward_labels.size())
+    {
+        throw std::invalid_argument("Hub labels data doesn't match the graph");
+    }
+}
+
+// Важность вершины - число вершин, кратчайшие пути до которых проходят через неё,
+// суммарно по деревьям кратчайших путей от равномерно выбранных вершин. Через такие
+// вершины проходит больше всего путей, и ранние хабы отсекают большую часть
+// последующих поисков. Вершины с равной важностью упорядочиваются по степени
+template <typename Weight>
+std::vector<VertexId> HubLabels<Weight>::OrderByCoverage(const Graph& graph, size_t sample_count) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<size_t> coverage(vertex_count, 0);
+    std::vector<size_t> degrees(vertex_count, 0);
+
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        ++degrees[edge.from];
+        ++degrees[edge.to];
+    }
+
+    sample_count = std::min(sample_count, vertex_count);
+    std::vector<Weight> weights(vertex_count);
+    std::vector<EdgeId> prev_edges(vertex_count);
+    std::vector<size_t> subtree_sizes(vertex_count);
+    std::vector<VertexId> settled;
+    DijkstraQueue<Weight, VertexId> queue;
+
+    for (size_t sample = 0; sample < sample_count; ++sample) {
+        const VertexId source = static_cast<VertexId>(sample * vertex_count / sample_count);
+
+        std::fill(weights.begin(), weights.end(), UNREACHABLE_WEIGHT);
+        std::fill(prev_edges.begin(), prev_edges.end(), NONE_EDGE);
+        settled.clear();
+        weights[source] = ZERO_WEIGHT;
+        queue.Push(ZERO_WEIGHT, source);
+
+        while (!queue.IsEmpty()) {
+            const auto [weight, vertex] = queue.Pop();
+
+            if (weight > weights[vertex]) {
+                continue;
+            }
+            settled.push_back(vertex);
+
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+
+                if (weight + edge.weight < weights[edge.to]) {
+                    weights[edge.to] = weight + edge.weight;
+                    prev_edges[edge.to] = edge_id;
+                    queue.Push(weights[edge.to], edge.to);
+                }
+            }
+        }
+
+        // Размеры поддеревьев накапливаются от листьев к корню
+        for (const VertexId vertex : settled) {
+            subtree_sizes[vertex] = 1;
+        }
+        for (auto it = settled.rbegin(); it != settled.rend(); ++it) {
+            coverage[*it] += subtree_sizes[*it];
+
+            if (prev_edges[*it] != NONE_EDGE) {
+                subtree_sizes[graph.GetEdge(prev_edges[*it]).from] += subtree_sizes[*it];
+            }
+        }
+    }
+
+    std::vector<VertexId> result(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        result[vertex] = vertex;
+    }
+    std::stable_sort(result.begin(), result.end(), [&coverage, &degrees](VertexId lhs, VertexId rhs) {
+        return std::tie(coverage[lhs], degrees[lhs]) > std::tie(coverage[rhs], degrees[rhs]);
+    });
+
+    return result;
+}
+
+template <typename Weight>
+void HubLabels<Weight>::BuildLabels() {
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    // Входящие рёбра вершин в форме CSR для поиска в обратном направлении
+    std::vector<size_t> reverse_offsets(vertex_count + 1, 0);
+    std::vector<EdgeId> reverse_edges(graph_.GetEdgeCount());
+
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        ++reverse_offsets[graph_.GetEdge(edge_id).to + 1];
+    }
+    for (size_t i = 0; i < vertex_count; ++i) {
+        reverse_offsets[i + 1] += reverse_offsets[i];
+    }
+
+    std::vector<size_t> next(reverse_offsets.begin(), reverse_offsets.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        reverse_edges[next[graph_.GetEdge(edge_id).to]++] = edge_id;
+    }
+
+    // Метки пополняются в порядке рангов хабов и поэтому остаются отсортированными
+    Labels forward(vertex_count);
+    Labels backward(vertex_count);
+    std::vector<Weight> weights(vertex_count, UNREACHABLE_WEIGHT);
+    std::vector<EdgeId> edges(vertex_count, NONE_EDGE);
+    std::vector<Weight> hub_weights(vertex_count, UNREACHABLE_WEIGHT);
+    DijkstraQueue<Weight, VertexId> queue;
+
+    for (uint32_t rank = 0; rank < vertex_count; ++rank) {
+        RunPrunedSearch(rank, false, reverse_offsets, reverse_edges, forward, backward, weights, edges, hub_weights, queue);
+        RunPrunedSearch(rank, true, reverse_offsets, reverse_edges, forward, backward, weights, edges, hub_weights, queue);
+    }
+
+    PackLabels(forward, data_.forward_offsets, data_.forward_labels);
+    PackLabels(backward, data_.backward_offsets, data_.backward_labels);
+}
+
+// Путь от хаба до вершины уже покрыт, если через один из ранее обработанных хабов
+// существует путь не длиннее найденного; такая вершина не получает метку
+// и не продолжает поиск. Для проверки веса путей от хаба (или до хаба) через
+// хабы его собственной метки раскладываются в массив по рангам
+template <typename Weight>
+void HubLabels<Weight>::RunPrunedSearch(uint32_t rank, bool reverse, const std::vector<size_t>& reverse_offsets,
+                                        const std::vector<EdgeId>& reverse_edges, Labels& forward, Labels& backward,
+                                        std::vector<Weight>& weights, std::vector<EdgeId>& edges,
+                                        std::vector<Weight>& hub_weights, DijkstraQueue<Weight, VertexId>& queue) const
+{
+    const VertexId source = data_.hubs[rank];
+    // Метка хаба, по которой проверяется покрытие, и метки, пополняемые поиском
+    const std::vector<LabelEntry>& source_label = reverse ? backward[source] : forward[source];
+    Labels& target_labels = reverse ? forward : backward;
+
+    for (const LabelEntry& entry : source_label) {
+        hub_weights[entry.hub] = entry.weight;
+    }
+
+    std::vector<VertexId> touched{ source };
+    weights[source] = ZERO_WEIGHT;
+    queue.Push(ZERO_WEIGHT, source);
+
+    while (!queue.IsEmpty()) {
+        const auto [weight, vertex] = queue.Pop();
+
+        if (weight > weights[vertex]) {
+            continue;
+        }
+
+        const bool is_covered = std::any_of(target_labels[vertex].begin(), target_labels[vertex].end(),
+            [&hub_weights, weight = weight](const LabelEntry& entry) {
+                return hub_weights[entry.hub] != UNREACHABLE_WEIGHT && hub_weights[entry.hub] + entry.weight <= weight;
+            });
+        if (is_covered) {
+            continue;
+        }
+        target_labels[vertex].push_back({ rank, edges[vertex], weight });
+
+        auto relax = [&](EdgeId edge_id, VertexId next) {
+            const Weight next_weight = weight + graph_.GetEdge(edge_id).weight;
+
+            if (weights[next] == UNREACHABLE_WEIGHT) {
+                touched.push_back(next);
+            }
+            if (next_weight < weights[next]) {
+                weights[next] = next_weight;
+                edges[next] = edge_id;
+                queue.Push(next_weight, next);
+            }
+        };
+
+        if (reverse) {
+            for (size_t i = reverse_offsets[vertex]; i < reverse_offsets[vertex + 1]; ++i) {
+                relax(reverse_edges[i], graph_.GetEdge(reverse_edges[i]).from);
+            }
+        }
+        else {
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                relax(edge_id, graph_.GetEdge(edge_id).to);
+            }
+        }
+    }
+
+    for (const VertexId vertex : touched) {
+        weights[vertex] = UNREACHABLE_WEIGHT;
+        edges[vertex] = NONE_EDGE;
+    }
+    for (const LabelEntry& entry : source_label) {
+        hub_weights[entry.hub] = UNREACHABLE_WEIGHT;
+    }
+}
+
+template <typename Weight>
+void HubLabels<Weight>::PackLabels(Labels& labels, std::vector<size_t>& offsets, std::vector<LabelEntry>& packed) {
+    offsets.assign(labels.size() + 1, 0);
+    for (size_t vertex = 0; vertex < labels.size(); ++vertex) {
+        offsets[vertex + 1] = offsets[vertex] + labels[vertex].size();
+    }
+
+    packed.clear();
+    packed.reserve(offsets.back());
+    for (auto& label : labels) {
+        packed.insert(packed.end(), label.begin(), label.end());
+        label = {};
+    }
+}
+
+// Слияние прямой метки начала и обратной метки конца, отсортированных по рангу хаба
+template <typename Weight>
+typename HubLabels<Weight>::Meeting HubLabels<Weight>::FindMeeting(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+
+    const LabelEntry* forward = data_.forward_labels.data() + data_.forward_offsets[from];
+    const LabelEntry* forward_end = data_.forward_labels.data() + data_.forward_offsets[from + 1];
+    const LabelEntry* backward = data_.backward_labels.data() + data_.backward_offsets[to];
+    const LabelEntry* backward_end = data_.backward_labels.data() + data_.backward_offsets[to + 1];
+    Meeting result;
+
+    while (forward != forward_end && backward != backward_end) {
+        if (forward->hub < backward->hub) {
+            ++forward;
+        }
+        else if (backward->hub < forward->hub) {
+            ++backward;
+        }
+        else {
+            if (forward->weight + backward->weight < result.weight) {
+                result = { forward->hub, forward->weight + backward->weight };
+            }
+            ++forward;
+            ++backward;
+        }
+    }
+
+    return result;
+}
+
+template <typename Weight>
+const typename HubLabels<Weight>::LabelEntry& HubLabels<Weight>::FindEntry(const std::vector<size_t>& offsets,
+                                                                           const std::vector<LabelEntry>& labels,
+                                                                           VertexId vertex, uint32_t hub)
+{
+    const auto begin = labels.begin() + offsets[vertex];
+    const auto end = labels.begin() + offsets[vertex + 1];
+    const auto it = std::lower_bound(begin, end, hub, [](const LabelEntry& entry, uint32_t value) {
+        return entry.hub < value;
+    });
+
+    if (it == end || it->hub != hub) {
+        throw std::logic_error("Hub labels are inconsistent");
+    }
+
+    return *it;
+}
+
+template <typename Weight>
+std::optional<Weight> HubLabels<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+    if (from == to) {
+        return ZERO_WEIGHT;
+    }
+
+    const Meeting meeting = FindMeeting(from, to);
+
+    if (meeting.hub == NONE_HUB) {
+        return std::nullopt;
+    }
+
+    return meeting.weight;
+}
+
+// Путь до хаба восстанавливается по первым рёбрам прямых меток, путь от хаба -
+// по последним рёбрам обратных меток: вершины этих путей не были отсечены
+// при поиске от хаба и содержат его в своих метках
+template <typename Weight>
+std::optional<typename HubLabels<Weight>::RouteInfo> HubLabels<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from == to) {
+        if (from >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+
+        return RouteInfo{ ZERO_WEIGHT, {} };
+    }
+
+    const Meeting meeting = FindMeeting(from, to);
+
+    if (meeting.hub == NONE_HUB) {
+        return std::nullopt;
+    }
+
+    const VertexId hub = data_.hubs[meeting.hub];
+    std::vector<EdgeId> edges;
+
+    for (VertexId vertex = from; vertex != hub;) {
+        const EdgeId edge_id = FindEntry(data_.forward_offsets, data_.forward_labels, vertex, meeting.hub).edge;
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).to;
+    }
+
+    const size_t hub_position = edges.size();
+    for (VertexId vertex = to; vertex != hub;) {
+        const EdgeId edge_id = FindEntry(data_.backward_offsets, data_.backward_labels, vertex, meeting.hub).edge;
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).from;
+    }
+    std::reverse(edges.begin() + hub_position, edges.end());
+
+    return RouteInfo{ meeting.weight, std::move(edges) };
+}
+
+} // end of namespace graph
\ No newline at end of file
@@ -275,7 +275,7 @@ void PrintValue(const Value& value, const PrintContext& ctx) {
     ctx.out << value;
 }
 
-void PrintString(const std::string& value, std::ostream& out) {
+void PrintString(std::string_view value, std::ostream& out) {
     out.put('"');
     for (const char c : value) {
         switch (c) {
@@ -384,4 +384,98 @@ void Print(const Document& doc, std::ostream& output) {
     PrintNode(doc.GetRoot(), PrintContext{ output });
 }
 
+Writer::Writer(std::ostream& output) : output_(output) {
+    has_items_.reserve(8);
+}
+
+Writer& Writer::StartArray() {
+    Open('[');
+    return *this;
+}
+
+Writer& Writer::EndArray() {
+    Close(']');
+    return *this;
+}
+
+Writer& Writer::StartDict() {
+    Open('{');
+    return *this;
+}
+
+Writer& Writer::EndDict() {
+    Close('}');
+    return *this;
+}
+
+Writer& Writer::Key(std::string_view key) {
+    BeginItem();
+    PrintString(key, output_);
+    output_ << ": "sv;
+    after_key_ = true;
+    
+    return *this;
+}
+
+Writer& Writer::Value(const Node& value) {
+    BeginItem();
+    PrintNode(value, PrintContext{ output_, 4, static_cast<int>(has_items_.size()) * 4 });
+    
+    return *this;
+}
+
+Writer& Writer::Value(std::string_view value) {
+    BeginItem();
+    PrintString(value, output_);
+    
+    return *this;
+}
+
+Writer& Writer::Value(int value) {
+    BeginItem();
+    output_ << value;
+    
+    return *this;
+}
+
+Writer& Writer::Value(double value) {
+    BeginItem();
+    output_ << value;
+    
+    return *this;
+}
+
+// Значение словаря следует сразу за ключом, элемент массива начинается
+// с новой строки с отступом по глубине вложенности, как в Print
+void Writer::BeginItem() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (has_items_.empty()) {
+        return;
+    }
+    
+    if (has_items_.back()) {
+        output_ << ",\n"sv;
+    }
+    has_items_.back() = true;
+    
+    PrintContext{ output_, 4, static_cast<int>(has_items_.size()) * 4 }.PrintIndent();
+}
+
+void Writer::Open(char bracket) {
+    BeginItem();
+    output_.put(bracket);
+    output_.put('\n');
+    has_items_.push_back(false);
+}
+
+void Writer::Close(char bracket) {
+    has_items_.pop_back();
+    output_.put('\n');
+    PrintContext{ output_, 4, static_cast<int>(has_items_.size()) * 4 }.PrintIndent();
+    output_.put(bracket);
+}
+
 } // end of namespace json
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 #include <utility>
@@ -143,4 +144,39 @@ Document Load(std::istream& input);
 
 void Print(const Document& doc, std::ostream& output);
 
+// Потоковый вывод JSON без построения дерева узлов. Форматирование совпадает
+// с Print, если ключи словарей передаются в порядке возрастания, поэтому части
+// документа можно выводить как готовыми узлами, так и напрямую
+class Writer {
+public:
+    explicit Writer(std::ostream& output);
+
+    Writer& StartArray();
+    Writer& EndArray();
+    Writer& StartDict();
+    Writer& EndDict();
+    Writer& Key(std::string_view key);
+
+    Writer& Value(const Node& value);
+    Writer& Value(std::string_view value);
+    Writer& Value(const std::string& value) {
+        return Value(std::string_view(value));
+    }
+    Writer& Value(int value);
+    Writer& Value(double value);
+
+private:
+    // Вывод разделителя и отступа перед очередным элементом
+    void BeginItem();
+    // Начало и конец массива или словаря
+    void Open(char bracket);
+    void Close(char bracket);
+
+    std::ostream& output_;
+    // Признаки наличия элементов в открытых массивах и словарях
+    std::vector<bool> has_items_;
+    // Признак выведенного ключа, значение которого ещё не выведено
+    bool after_key_ = false;
+};
+
 } // end of namespace json
\ No newline at end of file
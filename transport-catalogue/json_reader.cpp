@@ -125,6 +125,36 @@ RouteSettings JsonReader::SetRouterSettings(const json::Node& router_settings) {
     result.bus_wait_time = router_settings.AsDict().at("bus_wait_time"s).AsInt();
     result.bus_velocity = router_settings.AsDict().at("bus_velocity"s).AsDouble();
     
+    // Необязательные настройки алгоритма поиска
+    const json::Dict& settings = router_settings.AsDict();
+    if (const auto it = settings.find("routing_algorithm"s); it != settings.end()) {
+        result.routing_algorithm = ParseRoutingAlgorithm(it->second.AsString());
+    }
+    if (const auto it = settings.find("trees_cache_size"s); it != settings.end()) {
+        result.trees_cache_size = it->second.AsInt();
+    }
+    if (const auto it = settings.find("store_routes_table"s); it != settings.end()) {
+        result.store_routes_table = it->second.AsBool();
+    }
+    if (const auto it = settings.find("thread_count"s); it != settings.end()) {
+        result.thread_count = it->second.AsInt();
+    }
+    if (const auto it = settings.find("landmark_count"s); it != settings.end()) {
+        result.landmark_count = it->second.AsInt();
+    }
+    if (const auto it = settings.find("route_cache_size"s); it != settings.end()) {
+        result.route_cache_size = it->second.AsInt();
+    }
+    if (const auto it = settings.find("fold_wait_vertices"s); it != settings.end()) {
+        result.fold_wait_vertices = it->second.AsBool();
+    }
+    if (const auto it = settings.find("prune_dominated_edges"s); it != settings.end()) {
+        result.prune_dominated_edges = it->second.AsBool();
+    }
+    if (const auto it = settings.find("hilbert_vertex_order"s); it != settings.end()) {
+        result.hilbert_vertex_order = it->second.AsBool();
+    }
+    
     return result;
 }
 
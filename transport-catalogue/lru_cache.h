@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+// Кэш с вытеснением давно не использованных элементов (LRU).
+// Ёмкость задаётся в условных единицах стоимости, каждый элемент
+// учитывается с указанной при добавлении стоимостью.
+// Класс не синхронизирован, блокировки обеспечивает владелец
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity) : capacity_(capacity) {}
+
+    // Поиск элемента; найденный элемент становится самым "свежим"
+    std::optional<Value> Get(const Key& key) {
+        const auto it = index_.find(key);
+
+        if (it == index_.end()) {
+            return std::nullopt;
+        }
+
+        items_.splice(items_.begin(), items_, it->second);
+        return it->second->value;
+    }
+
+    // Добавление элемента с вытеснением самых старых при превышении ёмкости
+    void Put(const Key& key, Value value, size_t cost = 1) {
+        if (cost > capacity_) {
+            return;
+        }
+
+        if (const auto it = index_.find(key); it != index_.end()) {
+            size_ -= it->second->cost;
+            items_.erase(it->second);
+            index_.erase(it);
+        }
+
+        items_.push_front({ key, std::move(value), cost });
+        index_[key] = items_.begin();
+        size_ += cost;
+
+        while (size_ > capacity_) {
+            const Item& oldest = items_.back();
+            size_ -= oldest.cost;
+            index_.erase(oldest.key);
+            items_.pop_back();
+        }
+    }
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+    size_t GetCapacity() const {
+        return capacity_;
+    }
+
+private:
+    struct Item {
+        Key key;
+        Value value;
+        size_t cost;
+    };
+
+    size_t capacity_;
+    size_t size_ = 0;
+    std::list<Item> items_;
+    std::unordered_map<Key, typename std::list<Item>::iterator, Hash> index_;
+};
+
+} // end of namespace cache
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "map_renderer.h"
 #include "serialization.h"
 
+#include <exception>
 #include <fstream>
 #include <iostream>
 
@@ -43,11 +44,21 @@ int main(int argc, char* argv[]) {
         std::ifstream db_file(data.GetSerializationSettingsData().AsDict().at("file"s).AsString(), std::ios::binary);
         
         if (db_file) {
-            auto [db, renderer, router, graph, vertex] = DeserializeDB(db_file);
-            
-            router.SetGraph(std::move(graph), std::move(vertex));
-            transport::RequestHandler handler(db, renderer, router);
-            handler.DatabaseRespond(data.GetStatRequestData(), std::cout);
+            // База другой версии или повреждённая база не обрабатывается:
+            // сообщение об ошибке выводится вместо аварийного завершения
+            try {
+                auto [db, renderer, router, load_graph] = DeserializeDB(db_file);
+                
+                // Граф загружается и маршрутизатор создаётся только при первом запросе маршрута
+                router.SetGraph(db, std::move(load_graph));
+                transport::RequestHandler handler(db, renderer, router);
+                handler.DatabaseRespond(data.GetStatRequestData(), std::cout);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: "sv << e.what() << '\n';
+                
+                return 1;
+            }
         }
         else {
             throw "File opening error";
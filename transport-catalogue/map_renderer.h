@@ -87,6 +87,8 @@ private:
     double zoom_coeff_ = 0;
 };
 
+// Визуализатор карты маршрутов. Построение карты не изменяет объект,
+// поэтому GetSVG можно вызывать из нескольких потоков одновременно
 class MapRenderer {
 public:
     MapRenderer() = default;
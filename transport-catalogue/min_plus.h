@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Векторные ядра собираются для x86 компиляторами с атрибутом target, поэтому
+// сборка не требует флагов -mavx2 и работает на процессорах без этих инструкций
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GRAPH_MIN_PLUS_X86
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+// Набор инструкций, которым выполняется релаксация строк таблицы маршрутов
+enum class MinPlusKernel {
+    SCALAR,
+    SSE42,
+    AVX2,
+};
+
+namespace min_plus_detail {
+
+template <typename Weight>
+inline constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                             ? std::numeric_limits<Weight>::infinity()
+                                             : std::numeric_limits<Weight>::max();
+
+template <typename EdgeIndex>
+inline constexpr EdgeIndex NONE_EDGE = std::numeric_limits<EdgeIndex>::max();
+
+// Векторные ядра есть для весов в минутах и в микросекундах и для номеров рёбер обеих разрядностей
+template <typename Weight, typename EdgeIndex>
+inline constexpr bool IS_VECTORIZABLE = (std::is_same_v<Weight, double> || std::is_same_v<Weight, uint64_t>)
+                                        && (std::is_same_v<EdgeIndex, uint16_t> || std::is_same_v<EdgeIndex, uint32_t>);
+
+// Релаксация ячеек [begin, end) без ветвлений: новые значения выбираются сравнением,
+// а ячейки, которые не стали короче, записываются прежними значениями
+template <typename Weight, typename EdgeIndex>
+void RelaxRowScalar(Weight* weights, EdgeIndex* prev_edges, Weight weight_from, EdgeIndex prev_edge_from,
+                    const Weight* pivot_weights, const EdgeIndex* pivot_prev_edges, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const Weight pivot_weight = pivot_weights[i];
+        const Weight candidate_weight = weight_from + pivot_weight;
+        const bool is_shorter = (pivot_weight != UNREACHABLE_WEIGHT<Weight>) & (candidate_weight < weights[i]);
+
+        const EdgeIndex pivot_prev_edge = pivot_prev_edges[i];
+        const EdgeIndex candidate_edge = pivot_prev_edge != NONE_EDGE<EdgeIndex> ? pivot_prev_edge : prev_edge_from;
+
+        weights[i] = is_shorter ? candidate_weight : weights[i];
+        prev_edges[i] = is_shorter ? candidate_edge : prev_edges[i];
+    }
+}
+
+#ifdef GRAPH_MIN_PLUS_X86
+
+// Загрузка и запись младших байт регистра
+template <size_t BYTES>
+__attribute__((target("sse4.2"))) inline __m128i LoadLow(const void* data) {
+    if constexpr (BYTES == 16) {
+        return _mm_loadu_si128(static_cast<const __m128i*>(data));
+    }
+    else if constexpr (BYTES == 8) {
+        return _mm_loadl_epi64(static_cast<const __m128i*>(data));
+    }
+    else {
+        static_assert(BYTES == 4, "Unsupported load size");
+        int32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return _mm_cvtsi32_si128(value);
+    }
+}
+
+template <size_t BYTES>
+__attribute__((target("sse4.2"))) inline void StoreLow(void* data, __m128i value) {
+    if constexpr (BYTES == 16) {
+        _mm_storeu_si128(static_cast<__m128i*>(data), value);
+    }
+    else if constexpr (BYTES == 8) {
+        _mm_storel_epi64(static_cast<__m128i*>(data), value);
+    }
+    else {
+        static_assert(BYTES == 4, "Unsupported store size");
+        const int32_t result = _mm_cvtsi128_si32(value);
+        std::memcpy(data, &result, sizeof(result));
+    }
+}
+
+// Выбор номеров рёбер для LANES ячеек по маске сократившихся путей
+// из 32-разрядных элементов: последнее ребро пути через опорную вершину
+// или ребро до неё, если путь от опорной вершины пуст
+template <size_t LANES, typename EdgeIndex>
+__attribute__((target("sse4.2"))) inline void BlendPrevEdges(EdgeIndex* prev_edges, const EdgeIndex* pivot_prev_edges,
+                                                             EdgeIndex prev_edge_from, __m128i is_shorter) {
+    constexpr size_t BYTES = LANES * sizeof(EdgeIndex);
+    const __m128i pivot_prev = LoadLow<BYTES>(pivot_prev_edges);
+    const __m128i current = LoadLow<BYTES>(prev_edges);
+    const __m128i none_edge = _mm_set1_epi32(-1);
+
+    __m128i candidate;
+    if constexpr (sizeof(EdgeIndex) == sizeof(uint32_t)) {
+        candidate = _mm_blendv_epi8(pivot_prev, _mm_set1_epi32(static_cast<int32_t>(prev_edge_from)),
+                                    _mm_cmpeq_epi32(pivot_prev, none_edge));
+    }
+    else {
+        candidate = _mm_blendv_epi8(pivot_prev, _mm_set1_epi16(static_cast<int16_t>(prev_edge_from)),
+                                    _mm_cmpeq_epi16(pivot_prev, none_edge));
+        is_shorter = _mm_packs_epi32(is_shorter, is_shorter);
+    }
+
+    StoreLow<BYTES>(prev_edges, _mm_blendv_epi8(current, candidate, is_shorter));
+}
+
+// Релаксация четырёх ячеек; возвращается маска сократившихся путей из 32-разрядных элементов.
+// Недостижимость в весах double - бесконечность, и сумма с ней никогда не меньше текущего веса
+__attribute__((target("avx2"))) inline __m128i RelaxWeightsAvx2(double* weights, const double* pivot_weights, double weight_from) {
+    const __m256d current = _mm256_loadu_pd(weights);
+    const __m256d candidate = _mm256_add_pd(_mm256_set1_pd(weight_from), _mm256_loadu_pd(pivot_weights));
+    const __m256d is_shorter = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+    _mm256_storeu_pd(weights, _mm256_blendv_pd(current, candidate, is_shorter));
+
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(is_shorter),
+                                                              _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)));
+}
+
+// Целые веса беззнаковые: сравнение выполняется после сдвига на знаковый бит,
+// а суммы с недостижимым весом исключаются маской
+__attribute__((target("avx2"))) inline __m128i RelaxWeightsAvx2(uint64_t* weights, const uint64_t* pivot_weights, uint64_t weight_from) {
+    const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights));
+    const __m256i pivot = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pivot_weights));
+    const __m256i candidate = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<int64_t>(weight_from)), pivot);
+
+    const __m256i is_unreachable = _mm256_cmpeq_epi64(pivot, _mm256_set1_epi64x(-1));
+    const __m256i is_less = _mm256_cmpgt_epi64(_mm256_xor_si256(current, sign), _mm256_xor_si256(candidate, sign));
+    const __m256i is_shorter = _mm256_andnot_si256(is_unreachable, is_less);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(weights), _mm256_blendv_epi8(current, candidate, is_shorter));
+
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(is_shorter, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)));
+}
+
+// Релаксация двух ячеек; маска сократившихся путей - в младших 32-разрядных элементах
+__attribute__((target("sse4.2"))) inline __m128i RelaxWeightsSse42(double* weights, const double* pivot_weights, double weight_from) {
+    const __m128d current = _mm_loadu_pd(weights);
+    const __m128d candidate = _mm_add_pd(_mm_set1_pd(weight_from), _mm_loadu_pd(pivot_weights));
+    const __m128d is_shorter = _mm_cmplt_pd(candidate, current);
+    _mm_storeu_pd(weights, _mm_blendv_pd(current, candidate, is_shorter));
+
+    return _mm_shuffle_epi32(_mm_castpd_si128(is_shorter), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+__attribute__((target("sse4.2"))) inline __m128i RelaxWeightsSse42(uint64_t* weights, const uint64_t* pivot_weights, uint64_t weight_from) {
+    const __m128i sign = _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+    const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights));
+    const __m128i pivot = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pivot_weights));
+    const __m128i candidate = _mm_add_epi64(_mm_set1_epi64x(static_cast<int64_t>(weight_from)), pivot);
+
+    const __m128i is_unreachable = _mm_cmpeq_epi64(pivot, _mm_set1_epi64x(-1));
+    const __m128i is_less = _mm_cmpgt_epi64(_mm_xor_si128(current, sign), _mm_xor_si128(candidate, sign));
+    const __m128i is_shorter = _mm_andnot_si128(is_unreachable, is_less);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(weights), _mm_blendv_epi8(current, candidate, is_shorter));
+
+    return _mm_shuffle_epi32(is_shorter, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+// Ядра обрабатывают строку по 4 (AVX2) или 2 (SSE4.2) ячейки, а остаток - скалярно
+template <typename Weight, typename EdgeIndex>
+__attribute__((target("avx2"))) void RelaxRowAvx2(Weight* weights, EdgeIndex* prev_edges, Weight weight_from, EdgeIndex prev_edge_from,
+                                                  const Weight* pivot_weights, const EdgeIndex* pivot_prev_edges, size_t count) {
+    constexpr size_t LANES = 4;
+    size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        const __m128i is_shorter = RelaxWeightsAvx2(weights + i, pivot_weights + i, weight_from);
+        BlendPrevEdges<LANES>(prev_edges + i, pivot_prev_edges + i, prev_edge_from, is_shorter);
+    }
+
+    RelaxRowScalar(weights, prev_edges, weight_from, prev_edge_from, pivot_weights, pivot_prev_edges, i, count);
+}
+
+template <typename Weight, typename EdgeIndex>
+__attribute__((target("sse4.2"))) void RelaxRowSse42(Weight* weights, EdgeIndex* prev_edges, Weight weight_from, EdgeIndex prev_edge_from,
+                                                     const Weight* pivot_weights, const EdgeIndex* pivot_prev_edges, size_t count) {
+    constexpr size_t LANES = 2;
+    size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        const __m128i is_shorter = RelaxWeightsSse42(weights + i, pivot_weights + i, weight_from);
+        BlendPrevEdges<LANES>(prev_edges + i, pivot_prev_edges + i, prev_edge_from, is_shorter);
+    }
+
+    RelaxRowScalar(weights, prev_edges, weight_from, prev_edge_from, pivot_weights, pivot_prev_edges, i, count);
+}
+
+#endif
+
+inline MinPlusKernel DetectMinPlusKernel() {
+#ifdef GRAPH_MIN_PLUS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return MinPlusKernel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return MinPlusKernel::SSE42;
+    }
+#endif
+
+    return MinPlusKernel::SCALAR;
+}
+
+} // end of namespace min_plus_detail
+
+// Ядро релаксации, выбранное по возможностям процессора при первом обращении
+inline MinPlusKernel GetMinPlusKernel() {
+    static const MinPlusKernel kernel = min_plus_detail::DetectMinPlusKernel();
+
+    return kernel;
+}
+
+// Релаксация строки таблицы маршрутов через опорную вершину в полукольце (min, +):
+// weights[i] = min(weights[i], weight_from + pivot_weights[i]) для count ячеек.
+// Ячейка, путь до которой сократился, получает последнее ребро пути от опорной вершины,
+// а если этот путь пуст - ребро prev_edge_from. Недостижимость обозначается
+// бесконечным или наибольшим весом, отсутствие ребра - наибольшим номером.
+// Векторные ядра выполняют те же сложения и сравнения, поэтому результат
+// не зависит от выбранного ядра
+template <typename Weight, typename EdgeIndex>
+void RelaxMinPlusRow(Weight* weights, EdgeIndex* prev_edges, Weight weight_from, EdgeIndex prev_edge_from,
+                     const Weight* pivot_weights, const EdgeIndex* pivot_prev_edges, size_t count) {
+#ifdef GRAPH_MIN_PLUS_X86
+    if constexpr (min_plus_detail::IS_VECTORIZABLE<Weight, EdgeIndex>) {
+        switch (GetMinPlusKernel()) {
+        case MinPlusKernel::AVX2:
+            min_plus_detail::RelaxRowAvx2(weights, prev_edges, weight_from, prev_edge_from,
+                                          pivot_weights, pivot_prev_edges, count);
+            return;
+        case MinPlusKernel::SSE42:
+            min_plus_detail::RelaxRowSse42(weights, prev_edges, weight_from, prev_edge_from,
+                                           pivot_weights, pivot_prev_edges, count);
+            return;
+        case MinPlusKernel::SCALAR:
+        default:
+            break;
+        }
+    }
+#endif
+
+    min_plus_detail::RelaxRowScalar(weights, prev_edges, weight_from, prev_edge_from,
+                                    pivot_weights, pivot_prev_edges, 0, count);
+}
+
+} // end of namespace graph
\ No newline at end of file
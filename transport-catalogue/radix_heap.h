@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Монотонная поразрядная очередь с приоритетом (radix heap) для беззнаковых ключей.
+// Извлекаемые ключи не убывают, а добавляемый ключ не меньше последнего извлечённого,
+// что выполняется для поиска Дейкстры с неотрицательными весами. Элемент попадает
+// в корзину по старшему биту, которым его ключ отличается от последнего извлечённого,
+// и за время поиска перекладывается не более чем по числу разрядов ключа раз
+template <typename Key, typename Value>
+class RadixHeap {
+public:
+    static_assert(std::is_unsigned_v<Key>, "Radix heap keys should be unsigned integers");
+
+    using Item = std::pair<Key, Value>;
+
+    void Push(Key key, Value value) {
+        buckets_[GetBucket(key)].push_back({ key, std::move(value) });
+        ++size_;
+    }
+
+    // Извлечение элемента с наименьшим ключом
+    Item Pop() {
+        if (buckets_[0].empty()) {
+            size_t bucket = 1;
+            while (buckets_[bucket].empty()) {
+                ++bucket;
+            }
+
+            // Минимальный ключ корзины становится последним извлечённым,
+            // после чего элементы корзины распределяются по младшим корзинам
+            std::vector<Item>& items = buckets_[bucket];
+            last_key_ = std::min_element(items.begin(), items.end(), [](const Item& lhs, const Item& rhs) {
+                return lhs.first < rhs.first;
+            })->first;
+
+            for (Item& item : items) {
+                buckets_[GetBucket(item.first)].push_back(std::move(item));
+            }
+            items.clear();
+        }
+
+        Item item = std::move(buckets_[0].back());
+        buckets_[0].pop_back();
+        --size_;
+
+        return item;
+    }
+
+    bool IsEmpty() const {
+        return size_ == 0;
+    }
+
+    void Clear() {
+        for (auto& bucket : buckets_) {
+            bucket.clear();
+        }
+        last_key_ = 0;
+        size_ = 0;
+    }
+
+private:
+    size_t GetBucket(Key key) const {
+        Key difference = key ^ last_key_;
+        size_t bucket = 0;
+
+        while (difference != 0) {
+            difference >>= 1;
+            ++bucket;
+        }
+
+        return bucket;
+    }
+
+    std::array<std::vector<Item>, std::numeric_limits<Key>::digits + 1> buckets_;
+    Key last_key_ = 0;
+    size_t size_ = 0;
+};
+
+// Двоичная куча с тем же интерфейсом для весов, не являющихся беззнаковыми целыми
+template <typename Key, typename Value>
+class BinaryHeap {
+public:
+    using Item = std::pair<Key, Value>;
+
+    void Push(Key key, Value value) {
+        items_.push_back({ key, std::move(value) });
+        std::push_heap(items_.begin(), items_.end(), std::greater<Item>());
+    }
+
+    Item Pop() {
+        std::pop_heap(items_.begin(), items_.end(), std::greater<Item>());
+        Item item = std::move(items_.back());
+        items_.pop_back();
+
+        return item;
+    }
+
+    bool IsEmpty() const {
+        return items_.empty();
+    }
+
+    void Clear() {
+        items_.clear();
+    }
+
+private:
+    std::vector<Item> items_;
+};
+
+// Очередь поиска Дейкстры: поразрядная для целочисленных весов, иначе двоичная куча
+template <typename Weight, typename Value>
+using DijkstraQueue = std::conditional_t<std::is_integral_v<Weight> && std::is_unsigned_v<Weight>,
+                                         RadixHeap<Weight, Value>, BinaryHeap<Weight, Value>>;
+
+} // end of namespace graph
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "request_handler.h"
 
+#include <algorithm>
+#include <deque>
+#include <map>
 #include <utility>
 #include <sstream>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace transport {
 
@@ -13,41 +18,68 @@ RequestHandler::RequestHandler(const Catalogue& db, const MapRenderer& renderer,
     : db_(db), renderer_(renderer), router_(router) {}
 
 // Метод для формирование ответа
-void RequestHandler::DatabaseRespond(const json::Node& doc, std::ostream& output) {
-    json::Array output_array;
-    
+void RequestHandler::DatabaseRespond(const json::Node& doc, std::ostream& output) const {
     const json::Array& arr = doc.AsArray();
-    output_array.reserve(arr.size());
+    
+    // Маршруты между остановками планируются заранее, а ответы выводятся
+    // в поток по мере обхода запросов без сборки общего массива. Запросы планируются
+    // частями до очередного запроса статистики, чтобы он получал счётчики поиска
+    // только для предшествующих ему запросов
+    std::vector<RoutePlan> route_plans(arr.size());
+    size_t planned_end = 0;
+    // Буферы построения маршрутов переиспользуются всеми запросами пакета
+    Router::RouteScratch route_scratch;
+    
+    json::Writer writer(output);
+    writer.StartArray();
     
     // Цикл по массиву запросов
-    for (auto& request_node : arr) {
-        const json::Dict& request = request_node.AsDict();
+    for (size_t i = 0; i < arr.size(); ++i) {
+        if (i >= planned_end) {
+            planned_end = PlanRoutes(arr, i, route_plans) + 1;
+        }
+        
+        const json::Dict& request = arr[i].AsDict();
         const std::string& type = request.at("type"s).AsString();
         
         // Вызов функции вывода информации об объекте
         // Если тип запроса - Маршрут
         if (type == "Bus"s) {
-            output_array.push_back(BusRespond(request));
+            writer.Value(BusRespond(request));
         }
         
         // Если тип запроса - Остановка
         if (type == "Stop"s) {
-            output_array.push_back(StopRespond(request));
+            writer.Value(StopRespond(request));
         }
         
         // Если тип запроса - Визуализация
         if (type == "Map"s) {
-            output_array.push_back(MapImageRespond(request));
+            writer.Value(MapImageRespond(request));
         }
         
         // Если тип запроса - Маршрут между двумя остановками
         if (type == "Route"s) {
-            output_array.push_back(RouteRespond(request));
+            WriteRouteRespond(writer, route_plans, i, request.at("id"s).AsInt(), route_scratch);
+        }
+        
+        // Если тип запроса - Матрица времени в пути между остановками
+        if (type == "RouteMatrix"s) {
+            writer.Value(RouteMatrixRespond(request));
+        }
+        
+        // Если тип запроса - Статистика поиска маршрутов
+        if (type == "RoutingStats"s) {
+            writer.Value(RoutingStatsRespond(request));
+        }
+        
+        // Если тип запроса - Остановки, достижимые за ограниченное время
+        if (type == "Isochrone"s) {
+            writer.Value(IsochroneRespond(request, route_scratch));
         }
     }
     
-    // Вывод полученного результата
-    json::Print(json::Document(json::Node(std::move(output_array))), output);
+    writer.EndArray();
 }
 
 // Возвращает SVG-документ, представляющий карту маршрутов
@@ -56,7 +88,7 @@ svg::Document RequestHandler::RenderMap() const {
 }
 
 // Возвращает ответ на запрос с информацией автобусного маршрута
-json::Node RequestHandler::BusRespond(const json::Dict& request) {
+json::Node RequestHandler::BusRespond(const json::Dict& request) const {
     // Получение идентификатора запроса
     int id = request.at("id"s).AsInt();
     // Получение номера маршрута
@@ -100,7 +132,7 @@ json::Node RequestHandler::BusRespond(const json::Dict& request) {
 }
 
 // Возвращает ответ на запрос с информацией транспортной остановки
-json::Node RequestHandler::StopRespond(const json::Dict& request) {
+json::Node RequestHandler::StopRespond(const json::Dict& request) const {
     // Получение идентификатора запроса
     int id = request.at("id"s).AsInt();
     // Получение названия остановки
@@ -131,7 +163,7 @@ json::Node RequestHandler::StopRespond(const json::Dict& request) {
     }
 }
 
-json::Node RequestHandler::MapImageRespond(const json::Dict& request) {
+json::Node RequestHandler::MapImageRespond(const json::Dict& request) const {
     // Получение идентификатора запроса
     int id = request.at("id"s).AsInt();
     
@@ -146,32 +178,222 @@ json::Node RequestHandler::MapImageRespond(const json::Dict& request) {
         .EndDict().Build();
 }
 
-json::Node RequestHandler::RouteRespond(const json::Dict& request) {
+// Планирует ответы на запросы маршрутов пакета, начиная с запроса begin и до первого
+// следующего запроса статистики, и возвращает номер этого запроса или размер пакета.
+// Маршруты пар остановок, найденные в кэше маршрутизатора, используются сразу. Если
+// маршрутизатор отвечает на отдельные запросы без поиска, маршрут строится при выводе
+// ответа, иначе запросы группируются по остановке отправления, и маршруты группы строятся
+// одним поиском. План запроса с номером i в пакете помещается в элемент i массива plans
+size_t RequestHandler::PlanRoutes(const json::Array& requests, size_t begin, std::vector<RoutePlan>& plans) const {
+    // Группы запросов в порядке первого появления остановки отправления
+    struct RouteGroup {
+        const Stop* from;
+        std::vector<size_t> requests;
+        std::vector<const Stop*> to;
+    };
+    std::vector<RouteGroup> groups;
+    std::unordered_map<const Stop*, size_t> group_by_stop;
+    
+    // Первый запрос пакета для каждой пары остановок; повторные запросы
+    // обслуживаются при выводе после первого
+    std::map<std::pair<const Stop*, const Stop*>, size_t> first_requests;
+    
+    size_t i = begin;
+    for (; i < requests.size(); ++i) {
+        const json::Dict& request = requests[i].AsDict();
+        const std::string& type = request.at("type"s).AsString();
+        
+        if (type == "RoutingStats"s) {
+            break;
+        }
+        if (type != "Route"s) {
+            continue;
+        }
+        
+        RoutePlan& plan = plans[i];
+        plan.from = db_.FindStop(request.at("from"s).AsString());
+        plan.to = db_.FindStop(request.at("to"s).AsString());
+        
+        if (!plan.from || !plan.to) {
+            plan.from = plan.to = nullptr;
+            continue;
+        }
+        
+        const auto [first, inserted] = first_requests.emplace(std::pair{ plan.from, plan.to }, i);
+        plan.first = first->second;
+        
+        if (!inserted) {
+            continue;
+        }
+        if (plan.route = router_.FindCachedRoute(plan.from, plan.to); plan.route) {
+            plan.is_resolved = true;
+            continue;
+        }
+        if (router_.HasFastSingleRoutes()) {
+            continue;
+        }
+        
+        const auto [it, is_new_group] = group_by_stop.emplace(plan.from, groups.size());
+        if (is_new_group) {
+            groups.push_back({ plan.from, {}, {} });
+        }
+        groups[it->second].requests.push_back(i);
+        groups[it->second].to.push_back(plan.to);
+    }
+    
+    for (const RouteGroup& group : groups) {
+        auto routes = router_.GetRoutesInfo(group.from, group.to);
+        
+        for (size_t k = 0; k < group.requests.size(); ++k) {
+            RoutePlan& plan = plans[group.requests[k]];
+            plan.is_resolved = true;
+            
+            if (routes[k]) {
+                plan.route = std::make_shared<const RouteInfo>(std::move(*routes[k]));
+                router_.CacheRoute(plan.from, plan.to, plan.route);
+            }
+        }
+    }
+    
+    return i;
+}
+
+// Выводит ответ на запрос маршрута по его плану. Повторный запрос пары остановок
+// получает маршрут из кэша, а если маршрут в кэш не поместился - маршрут первого
+// запроса пары. Нерешённые при планировании маршруты строятся в буферы пакета
+void RequestHandler::WriteRouteRespond(json::Writer& writer, const std::vector<RoutePlan>& plans, size_t index, int id,
+                                       Router::RouteScratch& scratch) const
+{
+    const RoutePlan& plan = plans[index];
+    
+    if (!plan.from) {
+        WriteRouteRespond(writer, id, nullptr);
+        return;
+    }
+    if (plan.is_resolved) {
+        WriteRouteRespond(writer, id, plan.route.get());
+        return;
+    }
+    if (plan.first != index) {
+        if (const auto route = router_.FindCachedRoute(plan.from, plan.to)) {
+            WriteRouteRespond(writer, id, route.get());
+            return;
+        }
+        if (plans[plan.first].is_resolved) {
+            WriteRouteRespond(writer, id, plans[plan.first].route.get());
+            return;
+        }
+    }
+    
+    if (!router_.BuildRoute(plan.from, plan.to, scratch)) {
+        WriteRouteRespond(writer, id, nullptr);
+        return;
+    }
+    
+    router_.CacheRoute(plan.from, plan.to, scratch.route);
+    WriteRouteRespond(writer, id, &scratch.route);
+}
+
+// Выводит ответ на запрос маршрута; отсутствие маршрута означает, что маршрут не найден.
+// Ключи выводятся в порядке возрастания, как при выводе словаря
+void RequestHandler::WriteRouteRespond(json::Writer& writer, int id, const RouteInfo* route) const {
+    writer.StartDict();
+    
+    if (route) {
+        writer.Key("items"sv).StartArray();
+        router_.WriteEdgesItems(writer, route->edges);
+        writer.EndArray()
+            .Key("request_id"sv).Value(id)
+            .Key("total_time"sv).Value(WeightToMinutes(route->weight));
+    }
+    else {
+        writer.Key("error_message"sv).Value("not found"sv)
+            .Key("request_id"sv).Value(id);
+    }
+    
+    writer.EndDict();
+}
+
+// Возвращает матрицу времени в пути между списками остановок без состава маршрутов.
+// Для неизвестных и недостижимых остановок значение времени равно null
+json::Node RequestHandler::RouteMatrixRespond(const json::Dict& request) const {
     // Получение идентификатора запроса
     int id = request.at("id"s).AsInt();
     
-    const std::string& name_from = request.at("from"s).AsString();
-    const std::string& name_to = request.at("to"s).AsString();
-    
-    // Цикл по каждому элементу маршрута
-    if (const Stop* stop_from = db_.FindStop(name_from)) {
-        if (const Stop* stop_to = db_.FindStop(name_to)) {
-            if (auto ri = router_.GetRouteInfo(stop_from, stop_to)) {
-                auto [wieght, edges] = ri.value();
-                
-                return json::Builder{}.StartDict()
-                    .Key("items"s).Value(std::move(router_.GetEdgesItems(edges)))
-                    .Key("total_time"s).Value(wieght)
-                    .Key("request_id"s).Value(id)
-                    .EndDict().Build();
-            }
+    auto find_stops = [this](const json::Array& names) {
+        std::vector<const Stop*> stops;
+        stops.reserve(names.size());
+        
+        for (const auto& name : names) {
+            stops.push_back(db_.FindStop(name.AsString()));
+        }
+        
+        return stops;
+    };
+    
+    const auto travel_times = router_.GetTravelTimes(find_stops(request.at("from"s).AsArray()),
+                                                     find_stops(request.at("to"s).AsArray()));
+    
+    json::Array matrix;
+    matrix.reserve(travel_times.size());
+    
+    for (const auto& times : travel_times) {
+        json::Array row;
+        row.reserve(times.size());
+        
+        for (const auto& time : times) {
+            row.push_back(time ? json::Node(WeightToMinutes(*time)) : json::Node(nullptr));
         }
+        
+        matrix.push_back(std::move(row));
     }
     
     return json::Builder{}.StartDict()
-        .Key("error_message"s).Value("not found"s)
+        .Key("total_time"s).Value(std::move(matrix))
         .Key("request_id"s).Value(id)
         .EndDict().Build();
 }
 
+// Возвращает остановки, до которых от остановки from можно доехать не дольше чем
+// за max_time минут, со временем в пути в порядке его возрастания
+json::Node RequestHandler::IsochroneRespond(const json::Dict& request, Router::RouteScratch& scratch) const {
+    // Получение идентификатора запроса
+    int id = request.at("id"s).AsInt();
+    
+    const Stop* from = db_.FindStop(request.at("from"s).AsString());
+    if (!from) {
+        return json::Builder{}.StartDict()
+            .Key("error_message"s).Value("not found"s)
+            .Key("request_id"s).Value(id)
+            .EndDict().Build();
+    }
+    
+    const StopArrivals arrivals = router_.GetReachableStops(
+        from, MinutesToWeight(std::max(request.at("max_time"s).AsDouble(), 0.0)), scratch);
+    const std::deque<Stop>& all_stops = db_.GetAllStops();
+    
+    json::Array stops;
+    stops.reserve(arrivals.size());
+    
+    for (const auto& [stop_id, weight] : arrivals) {
+        stops.push_back(json::Builder{}.StartDict()
+            .Key("stop_name"s).Value(all_stops[stop_id].stop_title)
+            .Key("time"s).Value(WeightToMinutes(weight))
+            .EndDict().Build());
+    }
+    
+    return json::Builder{}.StartDict()
+        .Key("request_id"s).Value(id)
+        .Key("stops"s).Value(std::move(stops))
+        .EndDict().Build();
+}
+
+// Возвращает счётчики поиска маршрутов, накопленные с начала обработки запросов
+json::Node RequestHandler::RoutingStatsRespond(const json::Dict& request) const {
+    json::Dict result = router_.GetStats().AsDict();
+    result["request_id"s] = request.at("id"s).AsInt();
+    
+    return json::Node(std::move(result));
+}
+
 } // end of namespace transport
\ No newline at end of file
@@ -4,30 +4,58 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 namespace transport {
 
+// Обработчик запросов к загруженной базе. Обработчик не изменяет свои данные,
+// поэтому один объект может отвечать на пакеты запросов из нескольких потоков
+// одновременно, если каждый поток выводит ответ в свой поток вывода
 class RequestHandler {
 public:
     // Конструктор класса
     RequestHandler(const Catalogue& db, const MapRenderer& renderer, const Router& router);
     
     // Формирование ответа от базы данных транспортного каталога
-    void DatabaseRespond(const json::Node& doc, std::ostream& output);
+    void DatabaseRespond(const json::Node& doc, std::ostream& output) const;
     
     // Метод для создания SVG-документа с картой маршрутов автобусов
     svg::Document RenderMap() const;
 
 private:
     // Формирование информации о маршруте
-    json::Node BusRespond(const json::Dict& request);
+    json::Node BusRespond(const json::Dict& request) const;
     // Формирование информации об остановке
-    json::Node StopRespond(const json::Dict& request);
+    json::Node StopRespond(const json::Dict& request) const;
     // Формирование информации о визуализации
-    json::Node MapImageRespond(const json::Dict& request);
-    // Формирование информации о быстром/оптимальном пути
-    json::Node RouteRespond(const json::Dict& request);
+    json::Node MapImageRespond(const json::Dict& request) const;
+    // План ответа на запрос быстрого/оптимального пути
+    struct RoutePlan {
+        // Остановки запроса; nullptr, если одна из остановок не найдена
+        const Stop* from = nullptr;
+        const Stop* to = nullptr;
+        // Номер первого запроса пакета с той же парой остановок
+        size_t first = 0;
+        // Признак маршрута, найденного или не найденного при планировании
+        bool is_resolved = false;
+        // Маршрут из кэша или из общего поиска от остановки отправления
+        std::shared_ptr<const RouteInfo> route;
+    };
+    // Планирование ответов на запросы быстрого/оптимального пути пакета до очередного
+    // запроса статистики
+    size_t PlanRoutes(const json::Array& requests, size_t begin, std::vector<RoutePlan>& plans) const;
+    // Вывод информации о быстром/оптимальном пути по плану запроса
+    void WriteRouteRespond(json::Writer& writer, const std::vector<RoutePlan>& plans, size_t index, int id,
+                           Router::RouteScratch& scratch) const;
+    void WriteRouteRespond(json::Writer& writer, int id, const RouteInfo* route) const;
+    // Формирование матрицы времени в пути
+    json::Node RouteMatrixRespond(const json::Dict& request) const;
+    // Формирование статистики поиска маршрутов
+    json::Node RoutingStatsRespond(const json::Dict& request) const;
+    // Формирование списка остановок, достижимых за ограниченное время
+    json::Node IsochroneRespond(const json::Dict& request, Router::RouteScratch& scratch) const;
     
     // Ссылки на объекты
     const Catalogue& db_;
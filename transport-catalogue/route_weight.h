@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace transport {
+
+// Вес рёбер графа маршрутов - время в пути. По умолчанию время хранится в минутах
+// в типе double. При сборке с опцией TRANSPORT_INTEGER_WEIGHTS время хранится
+// в целых микросекундах: сравнения весов становятся целочисленными, а поиск
+// от одной вершины использует поразрядную очередь вместо двоичной кучи
+#ifdef TRANSPORT_INTEGER_WEIGHTS
+using Weight = uint64_t;
+inline constexpr double WEIGHT_UNITS_PER_MINUTE = 60.0 * 1000.0 * 1000.0;
+#else
+using Weight = double;
+inline constexpr double WEIGHT_UNITS_PER_MINUTE = 1.0;
+#endif
+
+inline constexpr bool HAS_INTEGER_WEIGHTS = std::is_integral_v<Weight>;
+
+inline constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                             ? std::numeric_limits<Weight>::infinity()
+                                             : std::numeric_limits<Weight>::max();
+
+// Перевод времени в минутах в вес и обратно. Бесконечное время соответствует недостижимости.
+// Целый вес ограничивается диапазоном llround: большее время переводится в недостижимый
+// вес, а отрицательное - в нулевой
+inline Weight MinutesToWeight(double minutes) {
+    if constexpr (HAS_INTEGER_WEIGHTS) {
+        const double units = minutes * WEIGHT_UNITS_PER_MINUTE;
+
+        if (std::isinf(minutes) || !(units < static_cast<double>(std::numeric_limits<long long>::max()))) {
+            return UNREACHABLE_WEIGHT;
+        }
+        if (units <= 0.0) {
+            return 0;
+        }
+        return static_cast<Weight>(std::llround(units));
+    }
+    else {
+        return minutes;
+    }
+}
+
+inline double WeightToMinutes(Weight weight) {
+    if constexpr (HAS_INTEGER_WEIGHTS) {
+        if (weight == UNREACHABLE_WEIGHT) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return static_cast<double>(weight) / WEIGHT_UNITS_PER_MINUTE;
+    }
+    else {
+        return weight;
+    }
+}
+
+// Время поездки на автобусе по дорожному расстоянию в метрах и скорости в км/ч.
+// Используется и для рёбер графа, и поиском по раундам, поэтому веса совпадают
+inline Weight GetRideWeight(int distance, double bus_velocity) {
+    return MinutesToWeight(static_cast<double>(distance) / (bus_velocity * (100.0 / 6.0)));
+}
+
+} // end of namespace transport
\ No newline at end of file
@@ -1,13 +1,19 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "radix_heap.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <tuple>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -15,106 +21,910 @@
 namespace graph {
 
 template <typename Weight>
+struct RouteInfo {
+    Weight weight;
+    std::vector<EdgeId> edges;
+};
+
+// Счётчики поиска по запросу: количество запросов и окончательно
+// обработанных вершин, по которым оценивается отсечение поиска
+struct SearchStats {
+    size_t query_count = 0;
+    size_t settled_vertex_count = 0;
+};
+
+// Маршрутизатор с таблицей кратчайших путей для всех пар вершин.
+// Таблица хранится построчно в двух непрерывных массивах: весов путей и
+// номеров последних рёбер. Для каждой компоненты слабой связности графа
+// хранится своя таблица, и память занимает сумма квадратов размеров компонент
+// вместо квадрата количества вершин. Тип номера ребра задаётся параметром шаблона,
+// недостижимость и отсутствие ребра обозначаются специальными значениями
+template <typename Weight, typename EdgeIndex = uint32_t>
 class Router {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
 
+    static_assert(std::is_unsigned_v<EdgeIndex>, "Edge index should be an unsigned integer");
+
 public:
-    explicit Router(const Graph& graph);
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                 ? std::numeric_limits<Weight>::infinity()
+                                                 : std::numeric_limits<Weight>::max();
+    static constexpr EdgeIndex NONE_EDGE = std::numeric_limits<EdgeIndex>::max();
 
-    struct RouteInfo {
-        Weight weight;
-        std::vector<EdgeId> edges;
+    struct RoutesInternalData {
+        std::vector<Weight> weights;
+        std::vector<EdgeIndex> prev_edges;
     };
 
+    // Количество потоков 0 означает использование всех ядер
+    explicit Router(const Graph& graph, size_t thread_count = 1);
+
+    // Конструктор для графа, каждое ребро которого начинается с посадки в его начальной вершине:
+    // вес ребра равен сумме веса посадки boarding_weight и веса поездки ride_weights[edge_id].
+    // Таблица рассчитывается с теми же суммами весов и тем же выбором среди путей равного веса,
+    // что и таблица графа, в котором посадка - отдельное ребро из вершины в её вершину
+    // отправления, а рёбра поездок выходят из вершин отправления. Обновления таблицы
+    // после изменения графа используют веса рёбер графа
+    Router(const Graph& graph, Weight boarding_weight, const std::vector<Weight>& ride_weights, size_t thread_count = 1);
+
+    // Конструктор, принимающий готовую таблицу маршрутов без повторного расчёта.
+    // Таблица должна быть рассчитана для того же графа: разбиение на компоненты
+    // восстанавливается по графу
+    Router(const Graph& graph, RoutesInternalData routes_internal_data);
+
+    // Проверка, что номера всех рёбер графа представимы типом EdgeIndex
+    static bool CanIndexEdges(size_t edge_count) {
+        return edge_count <= NONE_EDGE;
+    }
+
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Обход рёбер кратчайшего пути без выделения памяти на каждый запрос: номера рёбер
+    // собираются в буфер вызывающего, ёмкость которого сохраняется между вызовами,
+    // и visitor получает рёбра в порядке следования по пути
+    template <typename Visitor>
+    std::optional<Weight> VisitRoute(VertexId from, VertexId to, std::vector<EdgeId>& path, Visitor&& visitor) const;
+
+    // Вес кратчайшего пути из таблицы без восстановления рёбер
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+
+    // Таблицы компонент в порядке их наименьших вершин, записанные подряд
+    const RoutesInternalData& GetRoutesInternalData() const {
+        return routes_internal_data_;
+    }
+
+    // Обновление таблицы после добавления в граф рёбер с номерами от first_edge_id.
+    // Пересчитываются только пути, ставшие короче через новые рёбра,
+    // за O(V² · T), где T - количество различных конечных вершин новых рёбер
+    void AddEdges(EdgeId first_edge_id, size_t thread_count = 1);
+
+    // Обновление таблицы после удаления рёбер из графа по нумерации, возвращённой
+    // DirectedWeightedGraph::RemoveEdges. Заново рассчитываются только строки,
+    // деревья путей которых проходили через удалённые рёбра
+    void RemoveEdges(const std::vector<EdgeId>& new_edge_ids, size_t thread_count = 1);
+
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
+    // Компонента слабой связности графа: положение её вершин в общем списке
+    // вершин по компонентам и начало её таблицы в массивах таблицы маршрутов
+    struct Component {
+        size_t first_vertex = 0;
+        size_t vertex_count = 0;
+        size_t first_cell = 0;
     };
-    
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
-
-    void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
-            
-            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                
+
+    // Разбиение вершин графа на компоненты слабой связности. Между вершинами разных
+    // компонент нет пути ни в одном направлении, поэтому таблица хранит пути только
+    // для пар вершин одной компоненты: строка вершины имеет длину, равную размеру
+    // её компоненты, и индексируется номерами вершин внутри компоненты.
+    // Компоненты и вершины в них упорядочены по возрастанию номеров вершин,
+    // поэтому разбиение однозначно определяется графом
+    struct ComponentLayout {
+        std::vector<size_t> component_ids;
+        std::vector<size_t> local_ids;
+        std::vector<VertexId> vertices;
+        std::vector<Component> components;
+        size_t cell_count = 0;
+    };
+
+    static ComponentLayout MakeComponentLayout(const Graph& graph);
+
+    // Перенос таблицы на разбиение текущего графа после объединения или разделения
+    // компонент. Пути внутри прежних компонент сохраняются, остальные пары недостижимы
+    void UpdateComponentLayout();
+
+    const Component& GetComponent(VertexId vertex) const {
+        return layout_.components[layout_.component_ids[vertex]];
+    }
+
+    size_t GetRowOffset(VertexId vertex) const {
+        const Component& component = GetComponent(vertex);
+        return component.first_cell + layout_.local_ids[vertex] * component.vertex_count;
+    }
+
+    Weight* GetWeightsRow(VertexId vertex) {
+        return routes_internal_data_.weights.data() + GetRowOffset(vertex);
+    }
+
+    EdgeIndex* GetPrevEdgesRow(VertexId vertex) {
+        return routes_internal_data_.prev_edges.data() + GetRowOffset(vertex);
+    }
+
+    void InitializeComponent(const Component& component) {
+        for (size_t i = 0; i < component.vertex_count; ++i) {
+            const VertexId vertex = layout_.vertices[component.first_vertex + i];
+            Weight* weights = GetWeightsRow(vertex);
+            EdgeIndex* prev_edges = GetPrevEdgesRow(vertex);
+            weights[i] = ZERO_WEIGHT;
+
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+
+                const size_t to = layout_.local_ids[edge.to];
+                if (weights[to] > edge.weight) {
+                    weights[to] = edge.weight;
+                    prev_edges[to] = static_cast<EdgeIndex>(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from, const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight, route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // Строки таблицы компоненты, записанные подряд
+    struct TableRows {
+        Weight* weights = nullptr;
+        EdgeIndex* prev_edges = nullptr;
+    };
+
+    TableRows GetComponentRows(const Component& component) {
+        return { routes_internal_data_.weights.data() + component.first_cell,
+                 routes_internal_data_.prev_edges.data() + component.first_cell };
+    }
+
+    // Расчёт таблицы компоненты графа с посадкой в вершинах. Строки отправления - пути,
+    // начинающиеся после посадки, - рассчитываются во временной таблице и служат опорными
+    // строками, а в таблице маршрутов остаются строки путей от самих вершин
+    void RebuildBoardingComponent(const Component& component, Weight boarding_weight,
+                                  const std::vector<Weight>& ride_weights, parallel::ThreadPool& pool) {
+        const size_t vertex_count = component.vertex_count;
+        std::vector<Weight> departure_weights(vertex_count * vertex_count, UNREACHABLE_WEIGHT);
+        std::vector<EdgeIndex> departure_prev_edges(vertex_count * vertex_count, NONE_EDGE);
+
+        for (size_t i = 0; i < vertex_count; ++i) {
+            const VertexId vertex = layout_.vertices[component.first_vertex + i];
+            Weight* weights = departure_weights.data() + i * vertex_count;
+            EdgeIndex* prev_edges = departure_prev_edges.data() + i * vertex_count;
+            weights[i] = ZERO_WEIGHT;
+            GetWeightsRow(vertex)[i] = ZERO_WEIGHT;
+
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const Weight ride_weight = ride_weights[edge_id];
+
+                if (ride_weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+
+                const size_t to = layout_.local_ids[graph_.GetEdge(edge_id).to];
+                if (weights[to] > ride_weight) {
+                    weights[to] = ride_weight;
+                    prev_edges[to] = static_cast<EdgeIndex>(edge_id);
+                }
+            }
+        }
+
+        RelaxRowsBlocked(vertex_count, { departure_weights.data(), departure_prev_edges.data() },
+                         boarding_weight, GetComponentRows(component), pool);
+    }
+
+    // Полный пересчёт таблицы одной компоненты
+    void RebuildComponent(const Component& component, parallel::ThreadPool& pool) {
+        const size_t cell_count = component.vertex_count * component.vertex_count;
+        std::fill_n(routes_internal_data_.weights.begin() + component.first_cell, cell_count, UNREACHABLE_WEIGHT);
+        std::fill_n(routes_internal_data_.prev_edges.begin() + component.first_cell, cell_count, NONE_EDGE);
+        InitializeComponent(component);
+        RelaxRowsBlocked(component.vertex_count, GetComponentRows(component), ZERO_WEIGHT, {}, pool);
+    }
+
+    // Полный пересчёт таблицы по текущему графу вместе с его разбиением на компоненты
+    void RebuildRoutesInternalData(parallel::ThreadPool& pool) {
+        layout_ = MakeComponentLayout(graph_);
+        routes_internal_data_.weights.assign(layout_.cell_count, UNREACHABLE_WEIGHT);
+        routes_internal_data_.prev_edges.assign(layout_.cell_count, NONE_EDGE);
+
+        for (const Component& component : layout_.components) {
+            InitializeComponent(component);
+            RelaxRowsBlocked(component.vertex_count, GetComponentRows(component), ZERO_WEIGHT, {}, pool);
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // Обновление таблицы компоненты после добавления в неё рёбер edge_ids
+    void AddComponentEdges(const Component& component, const std::vector<EdgeId>& edge_ids, parallel::ThreadPool& pool);
+
+    // Номера рёбер пути от конечной вершины к начальной; nullopt, если путь не найден
+    std::optional<Weight> CollectReversedRoute(VertexId from, VertexId to, std::vector<EdgeId>& edges) const;
+
+    // Расчёт строки таблицы поиском Дейкстры от вершины; поиск не выходит за её компоненту
+    void RebuildRow(VertexId vertex_from) {
+        const std::vector<size_t>& local_ids = layout_.local_ids;
+        const size_t row_size = GetComponent(vertex_from).vertex_count;
+        Weight* weights = GetWeightsRow(vertex_from);
+        EdgeIndex* prev_edges = GetPrevEdgesRow(vertex_from);
+        std::fill(weights, weights + row_size, UNREACHABLE_WEIGHT);
+        std::fill(prev_edges, prev_edges + row_size, NONE_EDGE);
+
+        DijkstraQueue<Weight, VertexId> queue;
+        queue.Push(ZERO_WEIGHT, vertex_from);
+        weights[local_ids[vertex_from]] = ZERO_WEIGHT;
+
+        while (!queue.IsEmpty()) {
+            const auto [weight, vertex] = queue.Pop();
+
+            if (weight > weights[local_ids[vertex]]) {
+                continue;
+            }
+
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                const size_t to = local_ids[edge.to];
+
+                if (candidate_weight < weights[to]) {
+                    weights[to] = candidate_weight;
+                    prev_edges[to] = static_cast<EdgeIndex>(edge_id);
+                    queue.Push(candidate_weight, edge.to);
+                }
+            }
+        }
+    }
+
+    // Снимки строк опорных вершин блока и значений в их столбцах
+    struct PivotRows {
+        std::vector<Weight> weights;
+        std::vector<EdgeIndex> prev_edges;
+    };
+
+    // Релаксация столбцов [column_begin, column_end) строки через опорную вершину
+    // ядром min-plus, выбранным по набору инструкций процессора
+    static void RelaxRowSegment(Weight* weights, EdgeIndex* prev_edges, Weight weight_from, EdgeIndex prev_edge_from,
+                                const Weight* pivot_weights, const EdgeIndex* pivot_prev_edges,
+                                size_t column_begin, size_t column_end) {
+        RelaxMinPlusRow(weights + column_begin, prev_edges + column_begin, weight_from, prev_edge_from,
+                        pivot_weights + column_begin, pivot_prev_edges + column_begin, column_end - column_begin);
+    }
+
+    // Блочный алгоритм Флойда-Уоршелла. Каждая ячейка проходит те же релаксации
+    // в том же порядке опорных вершин и с теми же операндами, что и в построчном
+    // варианте, поэтому результат совпадает с ним побитово. Для этого строки
+    // опорных вершин и значения в их столбцах запоминаются на момент релаксации.
+    // Строки и столбцы таблицы table нумеруются номерами вершин внутри компоненты.
+    // Вес посадки прибавляется к весу пути до опорной вершины перед продолжением пути
+    // по её строке. Строки arrival_rows, если они заданы, релаксируются через опорные
+    // строки таблицы table так же, как её строки, но сами опорными не становятся
+    void RelaxRowsBlocked(size_t vertex_count, TableRows table, Weight boarding_weight, TableRows arrival_rows,
+                          parallel::ThreadPool& pool) {
+        const size_t row_count = arrival_rows.weights ? 2 * vertex_count : vertex_count;
+        const size_t tile_count = (vertex_count + COLUMN_TILE_SIZE - 1) / COLUMN_TILE_SIZE;
+        const size_t row_chunk_count = (row_count + ROW_CHUNK_SIZE - 1) / ROW_CHUNK_SIZE;
+
+        // Снимки строк опорных вершин блока на момент релаксации через них
+        PivotRows pivot_rows{ std::vector<Weight>(PIVOT_BLOCK_SIZE * vertex_count),
+                              std::vector<EdgeIndex>(PIVOT_BLOCK_SIZE * vertex_count) };
+        // Значения строк блока в столбцах опорных вершин на момент релаксации
+        PivotRows block_routes_from{ std::vector<Weight>(PIVOT_BLOCK_SIZE * PIVOT_BLOCK_SIZE),
+                                     std::vector<EdgeIndex>(PIVOT_BLOCK_SIZE * PIVOT_BLOCK_SIZE) };
+
+        // Строки таблицы, за которыми следуют строки arrival_rows
+        auto weights_row = [&](size_t row) {
+            return row < vertex_count ? table.weights + row * vertex_count
+                                      : arrival_rows.weights + (row - vertex_count) * vertex_count;
+        };
+        auto prev_edges_row = [&](size_t row) {
+            return row < vertex_count ? table.prev_edges + row * vertex_count
+                                      : arrival_rows.prev_edges + (row - vertex_count) * vertex_count;
+        };
+
+        auto snapshot_pivot_row = [&](size_t k, VertexId pivot, size_t column_begin, size_t column_end) {
+            std::copy(weights_row(pivot) + column_begin, weights_row(pivot) + column_end,
+                      pivot_rows.weights.data() + k * vertex_count + column_begin);
+            std::copy(prev_edges_row(pivot) + column_begin, prev_edges_row(pivot) + column_end,
+                      pivot_rows.prev_edges.data() + k * vertex_count + column_begin);
+        };
+
+        auto relax_row = [&](size_t row, size_t k, Weight weight_from, EdgeIndex prev_edge_from,
+                             size_t column_begin, size_t column_end) {
+            RelaxRowSegment(weights_row(row), prev_edges_row(row), weight_from + boarding_weight, prev_edge_from,
+                            pivot_rows.weights.data() + k * vertex_count, pivot_rows.prev_edges.data() + k * vertex_count,
+                            column_begin, column_end);
+        };
+
+        for (size_t block_begin = 0; block_begin < vertex_count; block_begin += PIVOT_BLOCK_SIZE) {
+            const size_t block_end = std::min(block_begin + PIVOT_BLOCK_SIZE, vertex_count);
+            const size_t block_size = block_end - block_begin;
+
+            // Обработка полосы столбцов без столбцов опорных вершин блока
+            auto for_each_tile_segment = [&](size_t tile, const auto& func) {
+                const size_t tile_begin = tile * COLUMN_TILE_SIZE;
+                const size_t tile_end = std::min(tile_begin + COLUMN_TILE_SIZE, vertex_count);
+
+                if (block_begin >= tile_end || block_end <= tile_begin) {
+                    func(tile_begin, tile_end);
+                }
+                else {
+                    func(tile_begin, block_begin);
+                    func(block_end, tile_end);
+                }
+            };
+
+            // 1. Опорный блок: строки и столбцы опорных вершин, последовательно
+            for (size_t k = 0; k < block_size; ++k) {
+                snapshot_pivot_row(k, block_begin + k, block_begin, block_end);
+
+                for (size_t r = 0; r < block_size; ++r) {
+                    const VertexId vertex_from = block_begin + r;
+                    const Weight weight_from = weights_row(vertex_from)[block_begin + k];
+                    const EdgeIndex prev_edge_from = prev_edges_row(vertex_from)[block_begin + k];
+                    block_routes_from.weights[r * PIVOT_BLOCK_SIZE + k] = weight_from;
+                    block_routes_from.prev_edges[r * PIVOT_BLOCK_SIZE + k] = prev_edge_from;
+
+                    if (weight_from != UNREACHABLE_WEIGHT) {
+                        relax_row(vertex_from, k, weight_from, prev_edge_from, block_begin, block_end);
                     }
                 }
             }
+
+            // 2. Остальные столбцы строк опорных вершин, параллельно по полосам
+            pool.ParallelFor(tile_count, [&](size_t tile) {
+                for_each_tile_segment(tile, [&](size_t column_begin, size_t column_end) {
+                    for (size_t k = 0; k < block_size; ++k) {
+                        snapshot_pivot_row(k, block_begin + k, column_begin, column_end);
+
+                        for (size_t r = 0; r < block_size; ++r) {
+                            const Weight weight_from = block_routes_from.weights[r * PIVOT_BLOCK_SIZE + k];
+
+                            if (weight_from != UNREACHABLE_WEIGHT) {
+                                relax_row(block_begin + r, k, weight_from, block_routes_from.prev_edges[r * PIVOT_BLOCK_SIZE + k],
+                                          column_begin, column_end);
+                            }
+                        }
+                    }
+                });
+            });
+
+            // 3. Остальные строки, параллельно по группам строк: сначала столбцы
+            // опорных вершин, затем полосы остальных столбцов
+            pool.ParallelFor(row_chunk_count, [&](size_t chunk) {
+                const size_t chunk_begin = chunk * ROW_CHUNK_SIZE;
+                const size_t chunk_end = std::min(chunk_begin + ROW_CHUNK_SIZE, row_count);
+                PivotRows routes_from{ std::vector<Weight>((chunk_end - chunk_begin) * block_size),
+                                       std::vector<EdgeIndex>((chunk_end - chunk_begin) * block_size) };
+
+                auto is_pivot = [&](size_t row) {
+                    return row >= block_begin && row < block_end;
+                };
+
+                for (size_t row = chunk_begin; row < chunk_end; ++row) {
+                    if (is_pivot(row)) {
+                        continue;
+                    }
+
+                    for (size_t k = 0; k < block_size; ++k) {
+                        const size_t index = (row - chunk_begin) * block_size + k;
+                        const Weight weight_from = weights_row(row)[block_begin + k];
+                        const EdgeIndex prev_edge_from = prev_edges_row(row)[block_begin + k];
+                        routes_from.weights[index] = weight_from;
+                        routes_from.prev_edges[index] = prev_edge_from;
+
+                        if (weight_from != UNREACHABLE_WEIGHT) {
+                            relax_row(row, k, weight_from, prev_edge_from, block_begin, block_end);
+                        }
+                    }
+                }
+
+                for (size_t tile = 0; tile < tile_count; ++tile) {
+                    for_each_tile_segment(tile, [&](size_t column_begin, size_t column_end) {
+                        for (size_t row = chunk_begin; row < chunk_end; ++row) {
+                            if (is_pivot(row)) {
+                                continue;
+                            }
+
+                            for (size_t k = 0; k < block_size; ++k) {
+                                const size_t index = (row - chunk_begin) * block_size + k;
+
+                                if (routes_from.weights[index] != UNREACHABLE_WEIGHT) {
+                                    relax_row(row, k, routes_from.weights[index], routes_from.prev_edges[index],
+                                              column_begin, column_end);
+                                }
+                            }
+                        }
+                    });
+                }
+            });
         }
     }
 
+    // Размеры блока опорных вершин, полосы столбцов и группы строк подобраны
+    // так, чтобы снимки опорных строк одной полосы помещались в кэш L2
+    static constexpr size_t PIVOT_BLOCK_SIZE = 32;
+    static constexpr size_t COLUMN_TILE_SIZE = 512;
+    static constexpr size_t ROW_CHUNK_SIZE = 64;
+
+    static_assert(COLUMN_TILE_SIZE % PIVOT_BLOCK_SIZE == 0, "Pivot block should lie within one column tile");
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
+    size_t vertex_count_;
+    ComponentLayout layout_;
     RoutesInternalData routes_internal_data_;
 };
 
-template <typename Weight>
-Router<Weight>::Router(const Graph& graph) : graph_(graph),
-    routes_internal_data_(graph.GetVertexCount(), std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+template <typename Weight, typename EdgeIndex>
+typename Router<Weight, EdgeIndex>::ComponentLayout Router<Weight, EdgeIndex>::MakeComponentLayout(const Graph& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    ComponentLayout result;
+
+    // Система непересекающихся множеств, корень множества - его наименьшая вершина
+    std::vector<VertexId> parents(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        parents[vertex] = vertex;
+    }
+
+    auto find_root = [&parents](VertexId vertex) {
+        while (parents[vertex] != vertex) {
+            parents[vertex] = parents[parents[vertex]];
+            vertex = parents[vertex];
+        }
+        return vertex;
+    };
+
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        const VertexId from_root = find_root(edge.from);
+        const VertexId to_root = find_root(edge.to);
+
+        if (from_root != to_root) {
+            parents[std::max(from_root, to_root)] = std::min(from_root, to_root);
+        }
+    }
+
+    // Корень обходится раньше остальных вершин своей компоненты
+    result.component_ids.resize(vertex_count);
+    result.local_ids.resize(vertex_count);
+
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const VertexId root = find_root(vertex);
+
+        if (root == vertex) {
+            result.component_ids[vertex] = result.components.size();
+            result.components.emplace_back();
+        }
+
+        Component& component = result.components[result.component_ids[root]];
+        result.component_ids[vertex] = result.component_ids[root];
+        result.local_ids[vertex] = component.vertex_count++;
+    }
+
+    size_t first_vertex = 0;
+    for (Component& component : result.components) {
+        component.first_vertex = first_vertex;
+        component.first_cell = result.cell_count;
+        first_vertex += component.vertex_count;
+        result.cell_count += component.vertex_count * component.vertex_count;
+    }
+
+    result.vertices.resize(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const Component& component = result.components[result.component_ids[vertex]];
+        result.vertices[component.first_vertex + result.local_ids[vertex]] = vertex;
+    }
+
+    return result;
+}
+
+template <typename Weight, typename EdgeIndex>
+void Router<Weight, EdgeIndex>::UpdateComponentLayout() {
+    ComponentLayout layout = MakeComponentLayout(graph_);
+
+    if (layout.component_ids == layout_.component_ids) {
+        return;
+    }
+
+    RoutesInternalData routes_internal_data{ std::vector<Weight>(layout.cell_count, UNREACHABLE_WEIGHT),
+                                             std::vector<EdgeIndex>(layout.cell_count, NONE_EDGE) };
+
+    for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+        const Component& component = layout.components[layout.component_ids[vertex_from]];
+        const size_t row_offset = component.first_cell + layout.local_ids[vertex_from] * component.vertex_count;
+        const Weight* weights = GetWeightsRow(vertex_from);
+        const EdgeIndex* prev_edges = GetPrevEdgesRow(vertex_from);
+
+        for (size_t i = 0; i < component.vertex_count; ++i) {
+            const VertexId vertex_to = layout.vertices[component.first_vertex + i];
+
+            if (layout_.component_ids[vertex_to] == layout_.component_ids[vertex_from]) {
+                routes_internal_data.weights[row_offset + i] = weights[layout_.local_ids[vertex_to]];
+                routes_internal_data.prev_edges[row_offset + i] = prev_edges[layout_.local_ids[vertex_to]];
+            }
+        }
+    }
+
+    layout_ = std::move(layout);
+    routes_internal_data_ = std::move(routes_internal_data);
+}
+
+template <typename Weight, typename EdgeIndex>
+Router<Weight, EdgeIndex>::Router(const Graph& graph, size_t thread_count)
+    : graph_(graph), vertex_count_(graph.GetVertexCount())
 {
-    InitializeRoutesInternalData(graph);
+    if (!CanIndexEdges(graph.GetEdgeCount())) {
+        throw std::length_error("Too many edges for the routes table edge index type");
+    }
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    parallel::ThreadPool pool(thread_count);
+    RebuildRoutesInternalData(pool);
+}
+
+template <typename Weight, typename EdgeIndex>
+Router<Weight, EdgeIndex>::Router(const Graph& graph, Weight boarding_weight, const std::vector<Weight>& ride_weights,
+                                  size_t thread_count)
+    : graph_(graph), vertex_count_(graph.GetVertexCount()), layout_(MakeComponentLayout(graph))
+{
+    if (!CanIndexEdges(graph.GetEdgeCount())) {
+        throw std::length_error("Too many edges for the routes table edge index type");
+    }
+    if (ride_weights.size() != graph.GetEdgeCount()) {
+        throw std::invalid_argument("Ride weights don't match the graph");
+    }
+    if (boarding_weight < ZERO_WEIGHT) {
+        throw std::domain_error("Edges' weights should be non-negative");
+    }
+
+    routes_internal_data_.weights.assign(layout_.cell_count, UNREACHABLE_WEIGHT);
+    routes_internal_data_.prev_edges.assign(layout_.cell_count, NONE_EDGE);
+
+    parallel::ThreadPool pool(thread_count);
+    for (const Component& component : layout_.components) {
+        RebuildBoardingComponent(component, boarding_weight, ride_weights, pool);
     }
 }
 
-template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from, VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    
-    if (!route_internal_data) {
+template <typename Weight, typename EdgeIndex>
+Router<Weight, EdgeIndex>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+    : graph_(graph), vertex_count_(graph.GetVertexCount()), layout_(MakeComponentLayout(graph)),
+      routes_internal_data_(std::move(routes_internal_data))
+{
+    const size_t cell_count = layout_.cell_count;
+
+    if (routes_internal_data_.weights.size() != cell_count || routes_internal_data_.prev_edges.size() != cell_count) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
+    }
+}
+
+template <typename Weight, typename EdgeIndex>
+void Router<Weight, EdgeIndex>::AddEdges(EdgeId first_edge_id, size_t thread_count) {
+    const size_t edge_count = graph_.GetEdgeCount();
+
+    if (graph_.GetVertexCount() != vertex_count_) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
+    }
+    if (!CanIndexEdges(edge_count)) {
+        throw std::length_error("Too many edges for the routes table edge index type");
+    }
+
+    for (EdgeId edge_id = first_edge_id; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+    }
+
+    if (first_edge_id >= edge_count) {
+        return;
+    }
+
+    // Новые рёбра могут объединить компоненты. Пути изменяются только внутри
+    // компонент, в которые попали новые рёбра, и компоненты обновляются независимо
+    UpdateComponentLayout();
+
+    std::vector<std::vector<EdgeId>> edges_by_component(layout_.components.size());
+    for (EdgeId edge_id = first_edge_id; edge_id < edge_count; ++edge_id) {
+        edges_by_component[layout_.component_ids[graph_.GetEdge(edge_id).from]].push_back(edge_id);
+    }
+
+    parallel::ThreadPool pool(thread_count);
+
+    for (size_t component_id = 0; component_id < edges_by_component.size(); ++component_id) {
+        if (!edges_by_component[component_id].empty()) {
+            AddComponentEdges(layout_.components[component_id], edges_by_component[component_id], pool);
+        }
+    }
+}
+
+template <typename Weight, typename EdgeIndex>
+void Router<Weight, EdgeIndex>::AddComponentEdges(const Component& component, const std::vector<EdgeId>& edge_ids,
+                                                  parallel::ThreadPool& pool)
+{
+    const size_t vertex_count = component.vertex_count;
+
+    auto weights_row = [&](size_t vertex) {
+        return routes_internal_data_.weights.data() + component.first_cell + vertex * vertex_count;
+    };
+    auto prev_edges_row = [&](size_t vertex) {
+        return routes_internal_data_.prev_edges.data() + component.first_cell + vertex * vertex_count;
+    };
+
+    // Концы новых рёбер (номера вершин внутри компоненты) с номерами в списке концов;
+    // конечные вершины перечисляются отдельно
+    std::vector<VertexId> vertices;
+    std::vector<size_t> targets;
+    std::unordered_map<VertexId, size_t> vertex_indices;
+    std::vector<bool> is_target;
+
+    auto get_index = [&](VertexId vertex) {
+        const auto [it, inserted] = vertex_indices.emplace(vertex, vertices.size());
+        if (inserted) {
+            vertices.push_back(vertex);
+            is_target.push_back(false);
+        }
+        return it->second;
+    };
+
+    for (const EdgeId edge_id : edge_ids) {
+        const auto& edge = graph_.GetEdge(edge_id);
+
+        get_index(layout_.local_ids[edge.from]);
+        const size_t to = get_index(layout_.local_ids[edge.to]);
+        if (!is_target[to]) {
+            is_target[to] = true;
+            targets.push_back(to);
+        }
+    }
+
+    if (targets.empty()) {
+        return;
+    }
+
+    // Обновление стоит порядка E³ + V·E·T + V²·T для E концов новых рёбер и V вершин
+    // компоненты; для длинных маршрутов таблица компоненты дешевле рассчитывается заново
+    const size_t end_count = vertices.size();
+
+    if (end_count * end_count * end_count + (vertex_count * end_count + vertex_count * vertex_count) * targets.size()
+        > vertex_count * vertex_count * vertex_count)
+    {
+        RebuildComponent(component, pool);
+
+        return;
+    }
+
+    // Кратчайшие пути между концами новых рёбер в новом графе: прежние пути
+    // из таблицы дополняются новыми рёбрами и замыкаются алгоритмом Флойда-Уоршелла
+    PivotRows ends{ std::vector<Weight>(end_count * end_count), std::vector<EdgeIndex>(end_count * end_count) };
+
+    for (size_t i = 0; i < end_count; ++i) {
+        for (size_t j = 0; j < end_count; ++j) {
+            ends.weights[i * end_count + j] = weights_row(vertices[i])[vertices[j]];
+            ends.prev_edges[i * end_count + j] = prev_edges_row(vertices[i])[vertices[j]];
+        }
+    }
+    for (const EdgeId edge_id : edge_ids) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const size_t index = vertex_indices.at(layout_.local_ids[edge.from]) * end_count
+                             + vertex_indices.at(layout_.local_ids[edge.to]);
+
+        if (edge.weight < ends.weights[index]) {
+            ends.weights[index] = edge.weight;
+            ends.prev_edges[index] = static_cast<EdgeIndex>(edge_id);
+        }
+    }
+    for (size_t k = 0; k < end_count; ++k) {
+        for (size_t i = 0; i < end_count; ++i) {
+            const Weight weight_from = ends.weights[i * end_count + k];
+
+            if (weight_from != UNREACHABLE_WEIGHT) {
+                RelaxRowSegment(ends.weights.data() + i * end_count, ends.prev_edges.data() + i * end_count,
+                                weight_from, ends.prev_edges[i * end_count + k],
+                                ends.weights.data() + k * end_count, ends.prev_edges.data() + k * end_count,
+                                0, end_count);
+            }
+        }
+    }
+
+    // Прежние строки конечных вершин: продолжения путей после последнего нового ребра
+    PivotRows target_rows{ std::vector<Weight>(targets.size() * vertex_count),
+                           std::vector<EdgeIndex>(targets.size() * vertex_count) };
+    for (size_t t = 0; t < targets.size(); ++t) {
+        const VertexId vertex = vertices[targets[t]];
+        std::copy(weights_row(vertex), weights_row(vertex) + vertex_count, target_rows.weights.data() + t * vertex_count);
+        std::copy(prev_edges_row(vertex), prev_edges_row(vertex) + vertex_count, target_rows.prev_edges.data() + t * vertex_count);
+    }
+
+    // Путь, ставший короче, проходит до конечной вершины t последнего нового ребра
+    // по путям между концами новых рёбер, а после неё - по прежнему пути из t.
+    // Строка изменяется, только если сократился путь хотя бы до одной конечной вершины
+    const size_t row_chunk_count = (vertex_count + ROW_CHUNK_SIZE - 1) / ROW_CHUNK_SIZE;
+
+    pool.ParallelFor(row_chunk_count, [&](size_t chunk) {
+        const size_t chunk_begin = chunk * ROW_CHUNK_SIZE;
+        const size_t chunk_end = std::min(chunk_begin + ROW_CHUNK_SIZE, vertex_count);
+        std::vector<std::tuple<size_t, Weight, EdgeIndex>> improved_targets;
+
+        for (VertexId vertex_from = chunk_begin; vertex_from < chunk_end; ++vertex_from) {
+            Weight* weights = weights_row(vertex_from);
+            EdgeIndex* prev_edges = prev_edges_row(vertex_from);
+            improved_targets.clear();
+
+            for (size_t t = 0; t < targets.size(); ++t) {
+                Weight best_weight = weights[vertices[targets[t]]];
+                EdgeIndex best_edge = NONE_EDGE;
+
+                for (size_t i = 0; i < end_count; ++i) {
+                    const Weight weight_to_end = weights[vertices[i]];
+                    const Weight weight_between = ends.weights[i * end_count + targets[t]];
+
+                    if (weight_to_end == UNREACHABLE_WEIGHT || weight_between == UNREACHABLE_WEIGHT) {
+                        continue;
+                    }
+                    if (weight_to_end + weight_between < best_weight) {
+                        best_weight = weight_to_end + weight_between;
+                        best_edge = ends.prev_edges[i * end_count + targets[t]];
+                    }
+                }
+
+                if (best_edge != NONE_EDGE) {
+                    improved_targets.emplace_back(t, best_weight, best_edge);
+                }
+            }
+
+            for (const auto& [t, weight_from, prev_edge_from] : improved_targets) {
+                RelaxRowSegment(weights, prev_edges, weight_from, prev_edge_from,
+                                target_rows.weights.data() + t * vertex_count,
+                                target_rows.prev_edges.data() + t * vertex_count, 0, vertex_count);
+            }
+        }
+    });
+}
+
+template <typename Weight, typename EdgeIndex>
+void Router<Weight, EdgeIndex>::RemoveEdges(const std::vector<EdgeId>& new_edge_ids, size_t thread_count) {
+    if (graph_.GetVertexCount() != vertex_count_) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
+    }
+
+    // Перенумерация рёбер в таблице. Номера последних рёбер строки образуют дерево
+    // путей от её вершины, поэтому строка затронута удалением, только если
+    // удалённое ребро встречается среди её последних рёбер
+    parallel::ThreadPool pool(thread_count);
+    std::vector<char> is_affected(vertex_count_, false);
+
+    pool.ParallelFor(vertex_count_, [&](size_t vertex_from) {
+        EdgeIndex* prev_edges = GetPrevEdgesRow(static_cast<VertexId>(vertex_from));
+        const size_t row_size = GetComponent(static_cast<VertexId>(vertex_from)).vertex_count;
+
+        for (size_t vertex_to = 0; vertex_to < row_size; ++vertex_to) {
+            if (prev_edges[vertex_to] == NONE_EDGE) {
+                continue;
+            }
+
+            const EdgeId edge_id = new_edge_ids.at(prev_edges[vertex_to]);
+            if (edge_id == Graph::REMOVED_EDGE) {
+                is_affected[vertex_from] = true;
+            }
+            else {
+                prev_edges[vertex_to] = static_cast<EdgeIndex>(edge_id);
+            }
+        }
+    });
+
+    std::vector<VertexId> affected_rows;
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        if (is_affected[vertex]) {
+            affected_rows.push_back(vertex);
+        }
+    }
+
+    // Поиск Дейкстры для строки обходит все рёбра графа, а полный пересчёт стоит
+    // порядка V² на строку; при большом количестве строк таблица рассчитывается заново
+    const size_t row_cost = graph_.GetEdgeCount() + vertex_count_;
+    if (affected_rows.size() * row_cost > vertex_count_ * vertex_count_ * vertex_count_) {
+        RebuildRoutesInternalData(pool);
+
+        return;
+    }
+
+    pool.ParallelFor(affected_rows.size(), [&](size_t i) {
+        RebuildRow(affected_rows[i]);
+    });
+
+    // После удаления рёбер компонента могла распасться на несколько
+    UpdateComponentLayout();
+}
+
+template <typename Weight, typename EdgeIndex>
+std::optional<Weight> Router<Weight, EdgeIndex>::GetRouteWeight(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+
+    // Вершины разных компонент недостижимы друг из друга
+    if (layout_.component_ids[from] != layout_.component_ids[to]) {
         return std::nullopt;
     }
-    
-    const Weight weight = route_internal_data->weight;
+
+    const Weight weight = routes_internal_data_.weights[GetRowOffset(from) + layout_.local_ids[to]];
+
+    if (weight == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    return weight;
+}
+
+template <typename Weight, typename EdgeIndex>
+std::optional<typename Router<Weight, EdgeIndex>::RouteInfo> Router<Weight, EdgeIndex>::BuildRoute(VertexId from, VertexId to) const {
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
-    {
-        edges.push_back(*edge_id);
+    const auto weight = CollectReversedRoute(from, to, edges);
+
+    if (!weight) {
+        return std::nullopt;
     }
     std::reverse(edges.begin(), edges.end());
 
-    return RouteInfo{weight, std::move(edges)};
+    return RouteInfo{*weight, std::move(edges)};
+}
+
+template <typename Weight, typename EdgeIndex>
+template <typename Visitor>
+std::optional<Weight> Router<Weight, EdgeIndex>::VisitRoute(VertexId from, VertexId to, std::vector<EdgeId>& path,
+                                                            Visitor&& visitor) const
+{
+    const auto weight = CollectReversedRoute(from, to, path);
+
+    if (weight) {
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            visitor(graph_.GetEdge(*it));
+        }
+    }
+
+    return weight;
+}
+
+template <typename Weight, typename EdgeIndex>
+std::optional<Weight> Router<Weight, EdgeIndex>::CollectReversedRoute(VertexId from, VertexId to,
+                                                                      std::vector<EdgeId>& edges) const
+{
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex is out of range");
+    }
+
+    if (layout_.component_ids[from] != layout_.component_ids[to]) {
+        return std::nullopt;
+    }
+
+    const std::vector<size_t>& local_ids = layout_.local_ids;
+    const Weight* weights = routes_internal_data_.weights.data() + GetRowOffset(from);
+    const EdgeIndex* prev_edges = routes_internal_data_.prev_edges.data() + GetRowOffset(from);
+
+    if (weights[local_ids[to]] == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    edges.clear();
+    for (EdgeIndex edge_id = prev_edges[local_ids[to]];
+         edge_id != NONE_EDGE;
+         edge_id = prev_edges[local_ids[graph_.GetEdge(edge_id).from]])
+    {
+        edges.push_back(edge_id);
+    }
+
+    return weights[local_ids[to]];
 }
 
 } // end of namespace graph
\ No newline at end of file
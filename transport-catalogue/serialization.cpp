@@ -1,7 +1,21 @@
 #include "serialization.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
 using namespace std::literals;
 
+namespace {
+
+// Версия формата базы. Увеличивается при изменении, после которого база
+// прежней версии не может быть прочитана правильно
+constexpr uint32_t BASE_FORMAT_VERSION = 1;
+
+} // end of namespace
+
 /*
 *   Сериализация
 */
@@ -9,13 +23,16 @@ using namespace std::literals;
 void SerializeDB(const Catalogue& db, const MapRenderer& renderer, const Router& router, std::ostream& output)
 {
     serialize::TransportCatalogue data;
+    data.set_format_version(BASE_FORMAT_VERSION);
     
-    for (const auto& [_, stop] : db.GetSortedAllStops()) {
-        *data.add_stop() = db.StopsSerialize(stop);
+    // Остановки и маршруты записываются в порядке добавления,
+    // чтобы после загрузки их номера совпадали с номерами в графе
+    for (const Stop& stop : db.GetAllStops()) {
+        *data.add_stop() = db.StopsSerialize(&stop);
     }
     
-    for (const auto& [_, bus] : db.GetSortedAllBuses()) {
-        *data.add_bus() = db.BusesSerialize(bus);
+    for (const Bus& bus : db.GetAllBuses()) {
+        *data.add_bus() = db.BusesSerialize(&bus);
     }
     
     *data.mutable_render_settings() = renderer.RenderSettingSerialize(renderer.GetRenderSettings());
@@ -139,54 +156,346 @@ Router RouterSettingsDeserialize(const serialize::Router& router) {
     
     result.bus_wait_time = router.router_settings().bus_wait_time();
     result.bus_velocity = router.router_settings().bus_velocity();
+    result.routing_algorithm = static_cast<RoutingAlgorithm>(router.router_settings().routing_algorithm());
+    result.trees_cache_size = router.router_settings().trees_cache_size();
+    result.store_routes_table = router.router_settings().store_routes_table();
+    result.thread_count = router.router_settings().thread_count();
+    result.landmark_count = router.router_settings().landmark_count();
+    result.route_cache_size = router.router_settings().route_cache_size();
+    result.fold_wait_vertices = router.router_settings().fold_wait_vertices();
+    result.prune_dominated_edges = router.router_settings().prune_dominated_edges();
+    result.hilbert_vertex_order = router.router_settings().hilbert_vertex_order();
     
     return result;
 }
 
-graph::DirectedWeightedGraph<double> GraphDeserialize(const serialize::Router& router) {
+graph::DirectedWeightedGraph<Weight> GraphDeserialize(const serialize::Router& router) {
     const serialize::Graph& g = router.graph();
-    std::vector<graph::Edge<double>> edges(g.edge_size());
-    std::vector<std::vector<graph::EdgeId>> incidence_lists(g.vertex_size());
+    std::vector<graph::Edge<Weight>> edges(g.edge_size());
     
     for (size_t i = 0; i < edges.size(); ++i) {
         const serialize::Edge& e = g.edge(i);
-        edges[i] = { e.name(), static_cast<size_t>(e.quality()),
-        static_cast<size_t>(e.from()), static_cast<size_t>(e.to()), e.weight() };
+        edges[i] = { e.item_id(), e.quality(), e.from(), e.to(), MinutesToWeight(e.weight()) };
+    }
+    
+    std::vector<size_t> incident_edges_offsets(g.incident_edges_offset().begin(), g.incident_edges_offset().end());
+    std::vector<graph::EdgeId> incident_edges(g.incident_edge().begin(), g.incident_edge().end());
+    
+    return graph::DirectedWeightedGraph<Weight>(std::move(edges), std::move(incident_edges_offsets), std::move(incident_edges));
+}
+
+// Количество ячеек таблицы определяется размером блока: таблица хранится только для пар
+// вершин одной компоненты связности, и её размер сверяет с графом конструктор маршрутизатора
+template <typename RoutesInternalData>
+RoutesInternalData RoutesTableDeserialize(const std::string& data) {
+    RoutesInternalData result;
+    const size_t cell_size = sizeof(result.weights[0]) + sizeof(result.prev_edges[0]);
+    
+    if (data.size() % cell_size != 0) {
+        throw std::runtime_error("Corrupted routes table");
+    }
+    
+    const size_t cell_count = data.size() / cell_size;
+    const size_t weights_size = cell_count * sizeof(result.weights[0]);
+    const size_t prev_edges_size = cell_count * sizeof(result.prev_edges[0]);
+    
+    result.weights.resize(cell_count);
+    result.prev_edges.resize(cell_count);
+    std::memcpy(result.weights.data(), data.data(), weights_size);
+    std::memcpy(result.prev_edges.data(), data.data() + weights_size, prev_edges_size);
+    
+    return result;
+}
+
+std::optional<RoutesTable> RoutesTableDeserialize(const serialize::Router& router) {
+    const std::string& data = router.routes_table();
+    
+    // Таблица записана блоком весов в представлении сборки; таблица с другим
+    // типом весов не загружается и рассчитывается заново
+    if (data.empty() || router.routes_table_integer_weights() != HAS_INTEGER_WEIGHTS) {
+        return std::nullopt;
+    }
+    
+    switch (router.routes_table_edge_index_size()) {
+    case sizeof(uint16_t):
+        return RoutesTableDeserialize<CompactAllPairsRouter::RoutesInternalData>(data);
+    case sizeof(uint32_t):
+        return RoutesTableDeserialize<AllPairsRouter::RoutesInternalData>(data);
+    default:
+        throw std::runtime_error("Unsupported routes table edge index size");
+    }
+}
+
+std::optional<ContractionData> ContractionHierarchyDeserialize(const serialize::Router& router) {
+    if (!router.has_contraction_hierarchy()) {
+        return std::nullopt;
+    }
+    
+    const serialize::ContractionHierarchy& ch = router.contraction_hierarchy();
+    ContractionData result;
+    
+    result.ranks.assign(ch.rank().begin(), ch.rank().end());
+    result.shortcuts.reserve(ch.shortcut_size());
+    
+    for (const auto& s : ch.shortcut()) {
+        result.shortcuts.push_back({ s.from(), s.to(), MinutesToWeight(s.weight()), s.first(), s.second() });
+    }
+    
+    return result;
+}
+
+std::optional<LandmarksData> LandmarksDeserialize(const serialize::Router& router) {
+    if (!router.has_landmarks()) {
+        return std::nullopt;
+    }
+    
+    const serialize::Landmarks& l = router.landmarks();
+    LandmarksData result;
+    
+    result.landmarks.assign(l.landmark().begin(), l.landmark().end());
+    result.forward_distances.reserve(l.forward_distance_size());
+    result.backward_distances.reserve(l.backward_distance_size());
+    
+    for (const double distance : l.forward_distance()) {
+        result.forward_distances.push_back(MinutesToWeight(distance));
+    }
+    for (const double distance : l.backward_distance()) {
+        result.backward_distances.push_back(MinutesToWeight(distance));
     }
     
-    for (size_t i = 0; i < incidence_lists.size(); ++i) {
-        const serialize::Vertex& v = g.vertex(i);
-        incidence_lists[i].reserve(v.edge_id_size());
+    return result;
+}
+
+std::optional<HubLabelsData> HubLabelsDeserialize(const serialize::Router& router) {
+    if (!router.has_hub_labels()) {
+        return std::nullopt;
+    }
+    
+    const serialize::HubLabels& h = router.hub_labels();
+    HubLabelsData result;
+    
+    result.hubs.assign(h.hub().begin(), h.hub().end());
+    result.forward_offsets.assign(h.forward_offset().begin(), h.forward_offset().end());
+    result.backward_offsets.assign(h.backward_offset().begin(), h.backward_offset().end());
+    
+    if (h.forward_edge_size() != h.forward_hub_size() || h.forward_weight_size() != h.forward_hub_size()
+        || h.backward_edge_size() != h.backward_hub_size() || h.backward_weight_size() != h.backward_hub_size())
+    {
+        throw std::runtime_error("Corrupted hub labels");
+    }
+    
+    result.forward_labels.reserve(h.forward_hub_size());
+    for (int i = 0; i < h.forward_hub_size(); ++i) {
+        result.forward_labels.push_back({ h.forward_hub(i), h.forward_edge(i), MinutesToWeight(h.forward_weight(i)) });
+    }
+    result.backward_labels.reserve(h.backward_hub_size());
+    for (int i = 0; i < h.backward_hub_size(); ++i) {
+        result.backward_labels.push_back({ h.backward_hub(i), h.backward_edge(i), MinutesToWeight(h.backward_weight(i)) });
+    }
+    
+    return result;
+}
+
+RoutingData RoutingDataDeserialize(const serialize::Router& router) {
+    return { RoutesTableDeserialize(router), ContractionHierarchyDeserialize(router), LandmarksDeserialize(router),
+             HubLabelsDeserialize(router), router.pruned_edge_count(),
+             { router.stop_position().begin(), router.stop_position().end() } };
+}
+
+// Функция проверяет, что массив смещений начинается с нуля, не убывает и заканчивается размером данных
+template <typename Offsets>
+bool IsValidOffsets(const Offsets& offsets, size_t vertex_count, size_t data_size) {
+    if (static_cast<size_t>(offsets.size()) != vertex_count + 1 || offsets[0] != 0
+        || static_cast<size_t>(offsets[offsets.size() - 1]) != data_size)
+    {
+        return false;
+    }
+    
+    return std::is_sorted(offsets.begin(), offsets.end());
+}
+
+// Функция возвращает количество ячеек таблицы всех пар: таблица хранится для пар вершин
+// каждой компоненты слабой связности графа
+size_t CountRoutesTableCells(const serialize::Graph& g, size_t vertex_count) {
+    std::vector<uint32_t> parents(vertex_count);
+    for (uint32_t vertex = 0; vertex < vertex_count; ++vertex) {
+        parents[vertex] = vertex;
+    }
+    
+    auto find_root = [&parents](uint32_t vertex) {
+        while (parents[vertex] != vertex) {
+            parents[vertex] = parents[parents[vertex]];
+            vertex = parents[vertex];
+        }
+        return vertex;
+    };
+    
+    for (const serialize::Edge& edge : g.edge()) {
+        const uint32_t from_root = find_root(edge.from());
+        const uint32_t to_root = find_root(edge.to());
         
-        for (const auto& id : v.edge_id()) {
-            incidence_lists[i].push_back(id);
+        if (from_root != to_root) {
+            parents[std::max(from_root, to_root)] = std::min(from_root, to_root);
         }
     }
     
-    return graph::DirectedWeightedGraph<double>(edges, incidence_lists);
+    std::vector<size_t> component_sizes(vertex_count, 0);
+    for (uint32_t vertex = 0; vertex < vertex_count; ++vertex) {
+        ++component_sizes[find_root(vertex)];
+    }
+    
+    size_t result = 0;
+    for (const size_t size : component_sizes) {
+        result += size * size;
+    }
+    
+    return result;
 }
 
-std::map<std::string, graph::VertexId> VertexDeserialize(const serialize::Router& router) {
-    std::map<std::string, graph::VertexId> result;
+// Функция проверяет размеры и смещения данных маршрутизатора при чтении базы. Проверка
+// выполняется за один проход по данным, а граф и маршрутизатор строятся по ним позже,
+// при первом поиске маршрута, поэтому повреждённая база обнаруживается до вывода ответов
+void ValidateRouterData(const serialize::Router& router, size_t stop_count, size_t bus_count) {
+    const serialize::Graph& g = router.graph();
+    const serialize::RouterSettings& settings = router.router_settings();
     
-    for (const auto& s : router.stop_id()) {
-        result[s.name()] = s.id();
+    // Поиск по раундам работает без графа, иначе на остановку приходится одна или две вершины
+    size_t vertex_count = 0;
+    if (settings.routing_algorithm() != serialize::RAPTOR) {
+        vertex_count = stop_count * (settings.fold_wait_vertices() ? 1 : 2);
     }
+    const size_t edge_count = g.edge_size();
     
-    return result;
+    if (!(g.incident_edges_offset().empty() && vertex_count == 0)
+        && !IsValidOffsets(g.incident_edges_offset(), vertex_count, g.incident_edge_size()))
+    {
+        throw std::runtime_error("Corrupted routing graph: incident edges offsets don't match the stops");
+    }
+    if (static_cast<size_t>(g.incident_edge_size()) != edge_count) {
+        throw std::runtime_error("Corrupted routing graph: incident edges don't match the edges");
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        for (uint32_t i = g.incident_edges_offset(vertex); i < g.incident_edges_offset(vertex + 1); ++i) {
+            if (g.incident_edge(i) >= edge_count || g.edge(g.incident_edge(i)).from() != vertex) {
+                throw std::runtime_error("Corrupted routing graph: incident edge is out of range");
+            }
+        }
+    }
+    for (const serialize::Edge& edge : g.edge()) {
+        if (edge.from() >= vertex_count || edge.to() >= vertex_count
+            || edge.item_id() >= (edge.quality() == 0 ? stop_count : bus_count))
+        {
+            throw std::runtime_error("Corrupted routing graph: edge is out of range");
+        }
+    }
+    
+    // Места остановок в нумерации вершин образуют перестановку остановок
+    if (!router.stop_position().empty()) {
+        std::vector<bool> is_taken(stop_count, false);
+        
+        if (static_cast<size_t>(router.stop_position_size()) != stop_count) {
+            throw std::runtime_error("Corrupted routing graph: stop positions don't match the stops");
+        }
+        for (const uint32_t position : router.stop_position()) {
+            if (position >= stop_count || is_taken[position]) {
+                throw std::runtime_error("Corrupted routing graph: stop positions don't match the stops");
+            }
+            is_taken[position] = true;
+        }
+    }
+    
+    const std::string& routes_table = router.routes_table();
+    if (!routes_table.empty() && router.routes_table_integer_weights() == HAS_INTEGER_WEIGHTS) {
+        const size_t index_size = router.routes_table_edge_index_size();
+        
+        if (index_size != sizeof(uint16_t) && index_size != sizeof(uint32_t)) {
+            throw std::runtime_error("Unsupported routes table edge index size");
+        }
+        if (routes_table.size() != CountRoutesTableCells(g, vertex_count) * (sizeof(Weight) + index_size)) {
+            throw std::runtime_error("Corrupted routes table");
+        }
+    }
+    
+    if (router.has_contraction_hierarchy()) {
+        const serialize::ContractionHierarchy& ch = router.contraction_hierarchy();
+        
+        if (static_cast<size_t>(ch.rank_size()) != vertex_count) {
+            throw std::runtime_error("Corrupted contraction hierarchy");
+        }
+        for (int i = 0; i < ch.shortcut_size(); ++i) {
+            const serialize::Shortcut& shortcut = ch.shortcut(i);
+            
+            if (shortcut.from() >= vertex_count || shortcut.to() >= vertex_count
+                || shortcut.first() >= edge_count + i || shortcut.second() >= edge_count + i)
+            {
+                throw std::runtime_error("Corrupted contraction hierarchy");
+            }
+        }
+    }
+    
+    if (router.has_landmarks()) {
+        const serialize::Landmarks& l = router.landmarks();
+        const size_t cell_count = vertex_count * l.landmark_size();
+        
+        if (static_cast<size_t>(l.forward_distance_size()) != cell_count
+            || static_cast<size_t>(l.backward_distance_size()) != cell_count
+            || std::any_of(l.landmark().begin(), l.landmark().end(), [vertex_count](uint32_t v) { return v >= vertex_count; }))
+        {
+            throw std::runtime_error("Corrupted landmarks");
+        }
+    }
+    
+    if (router.has_hub_labels()) {
+        const serialize::HubLabels& h = router.hub_labels();
+        auto is_valid_hub = [vertex_count](uint32_t hub) {
+            return hub < vertex_count;
+        };
+        auto is_valid_edge = [edge_count](uint32_t edge) {
+            return edge < edge_count || edge == std::numeric_limits<uint32_t>::max();
+        };
+        
+        if (static_cast<size_t>(h.hub_size()) != vertex_count
+            || h.forward_edge_size() != h.forward_hub_size() || h.forward_weight_size() != h.forward_hub_size()
+            || h.backward_edge_size() != h.backward_hub_size() || h.backward_weight_size() != h.backward_hub_size()
+            || !IsValidOffsets(h.forward_offset(), vertex_count, h.forward_hub_size())
+            || !IsValidOffsets(h.backward_offset(), vertex_count, h.backward_hub_size())
+            || !std::all_of(h.hub().begin(), h.hub().end(), is_valid_hub)
+            || !std::all_of(h.forward_hub().begin(), h.forward_hub().end(), is_valid_hub)
+            || !std::all_of(h.backward_hub().begin(), h.backward_hub().end(), is_valid_hub)
+            || !std::all_of(h.forward_edge().begin(), h.forward_edge().end(), is_valid_edge)
+            || !std::all_of(h.backward_edge().begin(), h.backward_edge().end(), is_valid_edge))
+        {
+            throw std::runtime_error("Corrupted hub labels");
+        }
+    }
 }
 
 DeserializeData DeserializeDB(std::istream& input) {
     Catalogue db;
     
     serialize::TransportCatalogue data;
-    data.ParseFromIstream(&input);
+    if (!data.ParseFromIstream(&input)) {
+        throw std::runtime_error("Failed to parse the base: the file is damaged or is not a transport catalogue base");
+    }
+    if (data.format_version() != BASE_FORMAT_VERSION) {
+        throw std::runtime_error("The base has format version "s + std::to_string(data.format_version())
+                                 + ", expected "s + std::to_string(BASE_FORMAT_VERSION)
+                                 + ": rebuild it with make_base"s);
+    }
     
     MapRenderer renderer(RenderSettingsDeserialize( data.render_settings() ));
     Router router(RouterSettingsDeserialize( data.router() ));
     
     StopDeserialize(db, data);
     RouteDeserialize(db, data);
+    ValidateRouterData(data.router(), data.stop_size(), data.bus_size());
+    
+    // Сообщение маршрутизатора переносится в загрузчик и освобождается вместе с ним
+    auto router_data = std::make_shared<serialize::Router>(std::move(*data.mutable_router()));
+    GraphLoader load_graph = [router_data](GraphData& graph, RoutingData& routing_data) {
+        graph = GraphDeserialize(*router_data);
+        routing_data = RoutingDataDeserialize(*router_data);
+    };
     
-    return { std::move(db), std::move(renderer), std::move(router), GraphDeserialize(data.router()), VertexDeserialize(data.router()) };
+    return { std::move(db), std::move(renderer), std::move(router), std::move(load_graph) };
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
 
 #include "json_reader.h"
@@ -21,6 +22,8 @@ void SerializeDB(const Catalogue& db, const MapRenderer& renderer, const Router&
 *   Десериализация
 */
 
-using DeserializeData = std::tuple<Catalogue, MapRenderer, Router, graph::DirectedWeightedGraph<double>, std::map<std::string, graph::VertexId>>;
+// Граф и данные предрасчёта маршрутов возвращаются загрузчиком, который преобразует
+// их из прочитанной базы только при первом поиске маршрута
+using DeserializeData = std::tuple<Catalogue, MapRenderer, Router, GraphLoader>;
 
 DeserializeData DeserializeDB(std::istream& input);
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "serialization.h"
+#include "transport_catalogue.pb.h"
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std::literals;
+
+namespace {
+
+// Функция строит базу по случайной сети с заданными настройками маршрутизатора
+std::string MakeSerializedBase(const std::string& routing_settings) {
+    tests::NetworkOptions options;
+    options.seed = 9;
+    options.routing_settings = routing_settings;
+    const auto base = tests::MakeBase(tests::MakeNetwork(options));
+
+    std::ostringstream output;
+    SerializeDB(base->db, *base->renderer, *base->router, output);
+
+    return output.str();
+}
+
+// Функция изменяет прочитанную базу и записывает её заново
+std::string Corrupt(const std::string& data, const std::function<void(serialize::Router&)>& corrupt) {
+    serialize::TransportCatalogue message;
+    message.ParseFromString(data);
+    corrupt(*message.mutable_router());
+
+    return message.SerializeAsString();
+}
+
+// Функция проверяет, что база отклоняется при чтении, до первого поиска маршрута
+bool IsRejectedOnLoad(const std::string& data) {
+    std::istringstream input(data);
+
+    try {
+        DeserializeDB(input);
+    }
+    catch (const std::runtime_error&) {
+        return true;
+    }
+
+    return false;
+}
+
+// Исправная база читается, и по ней строятся маршруты
+void TestValidBases() {
+    for (const std::string& algorithm : { "dijkstra"s, "all_pairs"s, "contraction_hierarchies"s, "alt"s, "hub_labels"s }) {
+        const std::string data = MakeSerializedBase("\"routing_algorithm\": \""s + algorithm + "\", \"store_routes_table\": true"s);
+        std::istringstream input(data);
+        auto [db, renderer, router, load_graph] = DeserializeDB(input);
+
+        router.SetGraph(db, std::move(load_graph));
+        const auto route = router.GetRouteInfo(&db.GetAllStops()[0], &db.GetAllStops()[1]);
+        ASSERT_HINT(!route || !route->edges.empty(), algorithm);
+    }
+}
+
+// База прежнего формата не содержит версии и отклоняется
+void TestOldFormatBase() {
+    serialize::TransportCatalogue message;
+    message.ParseFromString(MakeSerializedBase(""s));
+    message.clear_format_version();
+
+    ASSERT(IsRejectedOnLoad(message.SerializeAsString()));
+}
+
+// Повреждения графа обнаруживаются при чтении базы
+void TestCorruptedGraph() {
+    const std::string data = MakeSerializedBase(""s);
+
+    ASSERT(!IsRejectedOnLoad(data));
+    ASSERT(IsRejectedOnLoad(Corrupt(data, [](serialize::Router& r) {
+        r.mutable_graph()->mutable_edge(0)->set_to(1000000);
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(data, [](serialize::Router& r) {
+        r.mutable_graph()->mutable_edge(0)->set_item_id(1000000);
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(data, [](serialize::Router& r) {
+        r.mutable_graph()->mutable_incident_edges_offset()->RemoveLast();
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(data, [](serialize::Router& r) {
+        r.mutable_graph()->set_incident_edges_offset(1, 1000000);
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(data, [](serialize::Router& r) {
+        r.mutable_graph()->set_incident_edge(0, 1000000);
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(data, [](serialize::Router& r) {
+        r.set_stop_position(0, r.stop_position(1));
+    })));
+}
+
+// Повреждения данных предрасчёта маршрутов обнаруживаются при чтении базы
+void TestCorruptedRoutingData() {
+    const std::string all_pairs = MakeSerializedBase("\"routing_algorithm\": \"all_pairs\", \"store_routes_table\": true"s);
+    ASSERT(IsRejectedOnLoad(Corrupt(all_pairs, [](serialize::Router& r) {
+        r.mutable_routes_table()->resize(r.routes_table().size() - 1);
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(all_pairs, [](serialize::Router& r) {
+        r.mutable_routes_table()->append(std::string(sizeof(Weight) + r.routes_table_edge_index_size(), '\0'));
+    })));
+
+    const std::string ch = MakeSerializedBase("\"routing_algorithm\": \"contraction_hierarchies\""s);
+    ASSERT(IsRejectedOnLoad(Corrupt(ch, [](serialize::Router& r) {
+        r.mutable_contraction_hierarchy()->mutable_rank()->RemoveLast();
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(ch, [](serialize::Router& r) {
+        r.mutable_contraction_hierarchy()->mutable_shortcut(0)->set_second(1000000);
+    })));
+
+    const std::string alt = MakeSerializedBase("\"routing_algorithm\": \"alt\""s);
+    ASSERT(IsRejectedOnLoad(Corrupt(alt, [](serialize::Router& r) {
+        r.mutable_landmarks()->mutable_forward_distance()->RemoveLast();
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(alt, [](serialize::Router& r) {
+        r.mutable_landmarks()->set_landmark(0, 1000000);
+    })));
+
+    const std::string hub_labels = MakeSerializedBase("\"routing_algorithm\": \"hub_labels\""s);
+    ASSERT(IsRejectedOnLoad(Corrupt(hub_labels, [](serialize::Router& r) {
+        r.mutable_hub_labels()->set_forward_offset(1, 1000000);
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(hub_labels, [](serialize::Router& r) {
+        r.mutable_hub_labels()->set_backward_hub(0, 1000000);
+    })));
+    ASSERT(IsRejectedOnLoad(Corrupt(hub_labels, [](serialize::Router& r) {
+        r.mutable_hub_labels()->mutable_forward_weight()->RemoveLast();
+    })));
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestValidBases);
+    RUN_TEST(TestOldFormatBase);
+    RUN_TEST(TestCorruptedGraph);
+    RUN_TEST(TestCorruptedRoutingData);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
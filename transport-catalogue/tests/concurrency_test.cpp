@@ -0,0 +1,159 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "serialization.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t STOP_COUNT = 60;
+constexpr size_t THREAD_COUNT = 8;
+constexpr size_t ROUND_COUNT = 3;
+
+// Функция строит базу по случайной сети с заданными настройками маршрутизатора
+std::string MakeSerializedBase(const std::string& routing_settings) {
+    tests::NetworkOptions options;
+    options.stop_count = STOP_COUNT;
+    options.bus_count = 24;
+    options.seed = 13;
+    options.routing_settings = routing_settings;
+    const auto base = tests::MakeBase(tests::MakeNetwork(options));
+
+    std::ostringstream output;
+    SerializeDB(base->db, *base->renderer, *base->router, output);
+
+    return output.str();
+}
+
+// Функция строит пакет запросов всех типов, кроме RoutingStats, счётчики которого
+// зависят от порядка обработки. Пары остановок запросов Route повторяются, чтобы
+// потоки одновременно читали и пополняли кэш ответов
+json::Array MakeRequests() {
+    std::mt19937 generator(17);
+    auto random_stop = [&generator]() {
+        return tests::GetTestStopName(std::uniform_int_distribution<size_t>(0, STOP_COUNT - 1)(generator));
+    };
+
+    json::Array requests;
+    for (int id = 0; id < 400; ++id) {
+        const int type = id % 20;
+
+        if (type < 14) {
+            requests.push_back(json::Dict{ { "id"s, id }, { "type"s, "Route"s },
+                                           { "from"s, random_stop() }, { "to"s, random_stop() } });
+        }
+        else if (type < 16) {
+            requests.push_back(json::Dict{ { "id"s, id }, { "type"s, "Stop"s }, { "name"s, random_stop() } });
+        }
+        else if (type < 17) {
+            requests.push_back(json::Dict{ { "id"s, id }, { "type"s, "Bus"s }, { "name"s, "Bus "s + std::to_string(id % 24) } });
+        }
+        else if (type < 18) {
+            requests.push_back(json::Dict{ { "id"s, id }, { "type"s, "RouteMatrix"s },
+                                           { "from"s, json::Array{ random_stop(), random_stop() } },
+                                           { "to"s, json::Array{ random_stop(), random_stop(), random_stop() } } });
+        }
+        else if (type < 19) {
+            requests.push_back(json::Dict{ { "id"s, id }, { "type"s, "Isochrone"s },
+                                           { "from"s, random_stop() }, { "max_time"s, 25 } });
+        }
+        else if (id == 39) {
+            requests.push_back(json::Dict{ { "id"s, id }, { "type"s, "Map"s } });
+        }
+    }
+
+    return requests;
+}
+
+// Функция отвечает на пакет запросов по загруженной базе
+std::string Respond(const Catalogue& db, const MapRenderer& renderer, const Router& router, const json::Array& requests) {
+    RequestHandler handler(db, renderer, router);
+    std::ostringstream output;
+    handler.DatabaseRespond(json::Node(requests), output);
+
+    return output.str();
+}
+
+// Несколько потоков одновременно отвечают на пакет запросов по одной базе с отложенной
+// загрузкой графа: граф загружается первым потоком, начавшим поиск маршрута, а кэши
+// деревьев и ответов используются совместно. Ответ каждого потока должен совпасть
+// с ответом, полученным в одном потоке
+void CheckConcurrentRespond(const std::string& routing_settings) {
+    const std::string data = MakeSerializedBase(routing_settings);
+    const json::Array requests = MakeRequests();
+
+    std::string expected;
+    {
+        std::istringstream input(data);
+        auto [db, renderer, router, load_graph] = DeserializeDB(input);
+        router.SetGraph(db, std::move(load_graph));
+        expected = Respond(db, renderer, router, requests);
+    }
+    ASSERT_HINT(expected.find("\"total_time\"") != std::string::npos, routing_settings);
+
+    for (size_t round = 0; round < ROUND_COUNT; ++round) {
+        std::istringstream input(data);
+        auto [db, renderer, router, load_graph] = DeserializeDB(input);
+        router.SetGraph(db, std::move(load_graph));
+
+        std::vector<std::string> answers(THREAD_COUNT);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < THREAD_COUNT; ++i) {
+            threads.emplace_back([&, i] {
+                answers[i] = Respond(db, renderer, router, requests);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (size_t i = 0; i < THREAD_COUNT; ++i) {
+            ASSERT_HINT(answers[i] == expected, routing_settings + ", thread "s + std::to_string(i));
+        }
+    }
+}
+
+void TestDijkstra() {
+    // Малый кэш деревьев заставляет потоки вытеснять деревья друг друга
+    CheckConcurrentRespond("\"routing_algorithm\": \"dijkstra\", \"trees_cache_size\": 2, \"route_cache_size\": 4096"s);
+}
+
+void TestAllPairs() {
+    CheckConcurrentRespond("\"routing_algorithm\": \"all_pairs\", \"store_routes_table\": true"s);
+}
+
+void TestContractionHierarchies() {
+    CheckConcurrentRespond("\"routing_algorithm\": \"contraction_hierarchies\""s);
+}
+
+void TestAlt() {
+    CheckConcurrentRespond("\"routing_algorithm\": \"alt\", \"fold_wait_vertices\": true"s);
+}
+
+void TestHubLabels() {
+    CheckConcurrentRespond("\"routing_algorithm\": \"hub_labels\""s);
+}
+
+void TestRaptor() {
+    CheckConcurrentRespond("\"routing_algorithm\": \"raptor\""s);
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestDijkstra);
+    RUN_TEST(TestAllPairs);
+    RUN_TEST(TestContractionHierarchies);
+    RUN_TEST(TestAlt);
+    RUN_TEST(TestHubLabels);
+    RUN_TEST(TestRaptor);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// Функция добавляет в каталог кольцевой маршрут по заданным остановкам. Расстояние
+// задаётся только между остановками, для которых оно ещё не известно, чтобы не изменить
+// вес рёбер остальных маршрутов
+const transport::Bus& AddRingBus(transport::Catalogue& db, const std::string& name, const std::vector<size_t>& stops) {
+    std::vector<transport::Stop*> route;
+    for (const size_t stop : stops) {
+        route.push_back(db.FindStop(tests::GetTestStopName(stop)));
+    }
+    route.push_back(route.front());
+
+    for (size_t i = 0; i + 1 < route.size(); ++i) {
+        if (route[i]->GetStopsDistance(route[i + 1]) == 0) {
+            db.SetStopsDistance(route[i], route[i + 1], static_cast<int>(700 + 150 * i));
+        }
+    }
+
+    db.AddRoute(name, route, true);
+    transport::Bus* bus = db.FindRoute(name);
+    bus->final_stop = route.front();
+
+    return *bus;
+}
+
+// Функция проверяет, что маршрут составлен из смежных рёбер и его время равно сумме времени рёбер
+bool IsConsistentRoute(const transport::RouteInfo& route) {
+    double total = 0.0;
+    for (size_t i = 0; i < route.edges.size(); ++i) {
+        total += transport::WeightToMinutes(route.edges[i].weight);
+
+        if (i > 0 && route.edges[i - 1].to != route.edges[i].from) {
+            return false;
+        }
+    }
+
+    return std::abs(total - transport::WeightToMinutes(route.weight)) < 1e-6;
+}
+
+// Функция сравнивает маршруты между всеми парами остановок двух маршрутизаторов.
+// Каталоги могут быть разными объектами, поэтому остановки сопоставляются по названиям
+void CheckSameRoutes(const transport::Catalogue& db, const transport::Router& router,
+                     const transport::Catalogue& expected_db, const transport::Router& expected_router,
+                     const std::string& hint) {
+    size_t mismatch_count = 0;
+    size_t route_count = 0;
+
+    for (const transport::Stop& from : db.GetAllStops()) {
+        for (const transport::Stop& to : db.GetAllStops()) {
+            const auto route = router.GetRouteInfo(&from, &to);
+            const auto expected_route = expected_router.GetRouteInfo(expected_db.FindStop(from.stop_title),
+                                                                     expected_db.FindStop(to.stop_title));
+
+            if (route.has_value() != expected_route.has_value()) {
+                ++mismatch_count;
+                continue;
+            }
+            if (!route) {
+                continue;
+            }
+
+            ++route_count;
+            const double weight = transport::WeightToMinutes(route->weight);
+            const double expected_weight = transport::WeightToMinutes(expected_route->weight);
+            if (std::abs(weight - expected_weight) > 1e-6 * std::max(1.0, expected_weight) || !IsConsistentRoute(*route)) {
+                ++mismatch_count;
+            }
+        }
+    }
+
+    ASSERT_EQUAL_HINT(mismatch_count, size_t{ 0 }, hint);
+    ASSERT_HINT(route_count > db.GetAllStops().size(), hint + ": network has too few routes"s);
+}
+
+// Добавление маршрута и его удаление сравниваются с полным построением графа:
+// после добавления - по тому же каталогу, после удаления - по исходному каталогу
+void CheckAddRemoveBus(const tests::NetworkOptions& options, const std::vector<size_t>& new_bus_stops,
+                       bool is_compact_table) {
+    const json::Document input = tests::MakeNetwork(options);
+    const auto base = tests::MakeBase(input);
+    const auto original = tests::MakeBase(input);
+    const std::string hint = options.routing_settings.empty() ? "default settings"s : options.routing_settings;
+
+    ASSERT_EQUAL_HINT(transport::CompactAllPairsRouter::CanIndexEdges(base->router->GetGraph().GetEdgeCount()),
+                      is_compact_table, hint);
+
+    const transport::Bus& bus = AddRingBus(base->db, "Added bus"s, new_bus_stops);
+    base->router->AddBus(bus);
+
+    transport::JsonReader data(input);
+    const transport::Router rebuilt(data.SetRouterSettings(data.GetRoutingSettingsData()), base->db);
+    CheckSameRoutes(base->db, *base->router, base->db, rebuilt, hint + ": added bus"s);
+
+    base->router->RemoveBus(bus);
+    CheckSameRoutes(base->db, *base->router, original->db, *original->router, hint + ": removed bus"s);
+}
+
+// Настройки графа, с которыми проверяется таблица всех пар
+const std::vector<std::string> GRAPH_SETTINGS = {
+    ""s,
+    "\"fold_wait_vertices\": true"s,
+    "\"prune_dominated_edges\": true"s,
+    "\"hilbert_vertex_order\": true"s,
+};
+
+// Компактная таблица с 16-битными номерами рёбер в связной сети
+void TestCompactTable() {
+    for (const std::string& settings : GRAPH_SETTINGS) {
+        tests::NetworkOptions options;
+        options.seed = 3;
+        options.routing_settings = "\"routing_algorithm\": \"all_pairs\""s + (settings.empty() ? ""s : ", "s + settings);
+
+        CheckAddRemoveBus(options, { 1, 7, 12, 25, 33 }, true);
+    }
+}
+
+// Добавляемый маршрут связывает остановки трёх несвязанных городов, поэтому
+// таблицы компонент объединяются при добавлении и разделяются при удалении
+void TestComponentTables() {
+    for (const std::string& settings : GRAPH_SETTINGS) {
+        tests::NetworkOptions options;
+        options.stop_count = 45;
+        options.bus_count = 18;
+        options.seed = 5;
+        options.town_count = 3;
+        options.routing_settings = "\"routing_algorithm\": \"all_pairs\""s + (settings.empty() ? ""s : ", "s + settings);
+
+        CheckAddRemoveBus(options, { 0, 1, 2, 9 }, true);
+    }
+}
+
+// Таблица с 32-битными номерами рёбер в сети, рёбра которой не помещаются в компактную таблицу
+void TestPlainTable() {
+    tests::NetworkOptions options;
+    options.stop_count = 120;
+    options.bus_count = 30;
+    options.seed = 11;
+    options.max_bus_length = 110;
+    options.routing_settings = "\"routing_algorithm\": \"all_pairs\""s;
+
+    CheckAddRemoveBus(options, { 3, 17, 40, 41, 90, 101 }, false);
+}
+
+// Удаление доминируемых рёбер не меняет время маршрутов, в том числе после удаления
+// автобусов, рёбра которых доминировали над рёбрами повторяющих их автобусов
+void CheckPrunedEdges(const std::string& algorithm) {
+    tests::NetworkOptions options;
+    options.seed = 4;
+    options.tied_bus_count = 8;
+    options.routing_settings = "\"routing_algorithm\": \""s + algorithm + "\""s;
+    const auto base = tests::MakeBase(tests::MakeNetwork(options));
+
+    options.routing_settings += ", \"prune_dominated_edges\": true"s;
+    const auto pruned = tests::MakeBase(tests::MakeNetwork(options));
+
+    ASSERT_HINT(pruned->router->GetGraph().GetEdgeCount() < base->router->GetGraph().GetEdgeCount(), algorithm);
+    CheckSameRoutes(pruned->db, *pruned->router, base->db, *base->router, algorithm + ": pruned graph"s);
+
+    // Маршруты "Bus 0" - "Bus 3" повторяются маршрутами "Bus 16" - "Bus 19",
+    // рёбра которых были отброшены и должны вернуться в граф
+    for (const std::string& name : { "Bus 0"s, "Bus 1"s, "Bus 2"s, "Bus 3"s }) {
+        pruned->router->RemoveBus(*pruned->db.FindRoute(name));
+        base->router->RemoveBus(*base->db.FindRoute(name));
+    }
+    CheckSameRoutes(pruned->db, *pruned->router, base->db, *base->router, algorithm + ": removed buses"s);
+}
+
+void TestPrunedAllPairs() {
+    CheckPrunedEdges("all_pairs"s);
+}
+
+void TestPrunedDijkstra() {
+    CheckPrunedEdges("dijkstra"s);
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestCompactTable);
+    RUN_TEST(TestComponentTables);
+    RUN_TEST(TestPlainTable);
+    RUN_TEST(TestPrunedAllPairs);
+    RUN_TEST(TestPrunedDijkstra);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "route_weight.h"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t STOP_COUNT = 30;
+const std::string ISOLATED_STOP = "Isolated stop"s;
+
+// Функция строит базу по случайной сети двух городов и добавляет остановку,
+// через которую не проходит ни один маршрут
+std::unique_ptr<tests::TestBase> MakeIsochroneBase(const std::string& routing_settings) {
+    tests::NetworkOptions options;
+    options.stop_count = STOP_COUNT;
+    options.bus_count = 12;
+    options.seed = 8;
+    options.town_count = 2;
+    options.routing_settings = routing_settings;
+
+    json::Dict root = tests::MakeNetwork(options).GetRoot().AsDict();
+    json::Array base_requests = root.at("base_requests"s).AsArray();
+    base_requests.push_back(json::Dict{ { "type"s, "Stop"s }, { "name"s, ISOLATED_STOP },
+                                        { "latitude"s, 55.7 }, { "longitude"s, 37.7 }, { "road_distances"s, json::Dict{} } });
+    root["base_requests"s] = std::move(base_requests);
+
+    return tests::MakeBase(json::Document(json::Node(std::move(root))));
+}
+
+// Функция отвечает на один запрос Isochrone
+json::Dict RespondIsochrone(const tests::TestBase& base, const std::string& from, const json::Node& max_time) {
+    const json::Array requests{ json::Dict{ { "id"s, 1 }, { "type"s, "Isochrone"s }, { "from"s, from }, { "max_time"s, max_time } } };
+    std::istringstream output(tests::Respond(base, requests));
+
+    return json::Load(output).GetRoot().AsArray().front().AsDict();
+}
+
+// Функция возвращает время до остановок из ответа Isochrone
+std::map<std::string, double> GetStopTimes(const json::Dict& answer) {
+    std::map<std::string, double> result;
+    for (const json::Node& stop : answer.at("stops"s).AsArray()) {
+        result[stop.AsDict().at("stop_name"s).AsString()] = stop.AsDict().at("time"s).AsDouble();
+    }
+
+    return result;
+}
+
+// Нулевое и отрицательное время ограничивают ответ остановкой отправления
+void TestZeroMaxTime() {
+    const auto base = MakeIsochroneBase(""s);
+    const std::map<std::string, double> expected{ { tests::GetTestStopName(0), 0.0 } };
+
+    ASSERT(GetStopTimes(RespondIsochrone(*base, tests::GetTestStopName(0), 0)) == expected);
+    ASSERT(GetStopTimes(RespondIsochrone(*base, tests::GetTestStopName(0), -15.5)) == expected);
+}
+
+// Неизвестная остановка отправления
+void TestUnknownStop() {
+    const auto base = MakeIsochroneBase(""s);
+    const json::Dict answer = RespondIsochrone(*base, "Unknown stop"s, 30);
+
+    ASSERT_EQUAL(answer.at("error_message"s).AsString(), "not found"s);
+    ASSERT_EQUAL(answer.at("request_id"s).AsInt(), 1);
+    ASSERT(!answer.count("stops"s));
+}
+
+// От остановки без рёбер достижима только она сама
+void TestIsolatedStop() {
+    for (const std::string& algorithm : { "all_pairs"s, "raptor"s }) {
+        const auto base = MakeIsochroneBase("\"routing_algorithm\": \""s + algorithm + "\""s);
+        const std::map<std::string, double> expected{ { ISOLATED_STOP, 0.0 } };
+
+        ASSERT_HINT(GetStopTimes(RespondIsochrone(*base, ISOLATED_STOP, 1e6)) == expected, algorithm);
+    }
+}
+
+// Без ограничения времени ответ содержит все остановки города отправления со временем
+// маршрута до них, а время, не помещающееся в диапазон весов, не приводит к переполнению
+void TestUnboundedMaxTime() {
+    for (const std::string& algorithm : { "all_pairs"s, "raptor"s }) {
+        const auto base = MakeIsochroneBase("\"routing_algorithm\": \""s + algorithm + "\""s);
+
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (size_t to = 0; to < STOP_COUNT; ++to) {
+            pairs.push_back({ 0, to });
+        }
+        std::istringstream output(tests::Respond(*base, tests::MakeRouteRequests(pairs)));
+        const json::Array routes = json::Load(output).GetRoot().AsArray();
+
+        std::map<std::string, double> expected;
+        for (size_t to = 0; to < STOP_COUNT; ++to) {
+            if (routes[to].AsDict().count("total_time"s)) {
+                expected[tests::GetTestStopName(to)] = routes[to].AsDict().at("total_time"s).AsDouble();
+            }
+        }
+        ASSERT_HINT(expected.size() > 1 && expected.size() < STOP_COUNT, algorithm);
+
+        for (const double max_time : { 1e6, 1e300, std::numeric_limits<double>::max() }) {
+            const std::map<std::string, double> times = GetStopTimes(RespondIsochrone(*base, tests::GetTestStopName(0), max_time));
+
+            ASSERT_EQUAL_HINT(times.size(), expected.size(), algorithm);
+            for (const auto& [stop, time] : times) {
+                ASSERT_HINT(expected.count(stop) && std::abs(expected.at(stop) - time) < 1e-6, algorithm + ": "s + stop);
+            }
+        }
+    }
+}
+
+// Перевод времени в вес не выходит за диапазон весов
+void TestMinutesToWeightRange() {
+    using transport::MinutesToWeight;
+
+    ASSERT(MinutesToWeight(std::numeric_limits<double>::infinity()) == transport::UNREACHABLE_WEIGHT);
+    ASSERT(MinutesToWeight(0.0) == transport::Weight{});
+
+    if constexpr (transport::HAS_INTEGER_WEIGHTS) {
+        ASSERT(MinutesToWeight(1e300) == transport::UNREACHABLE_WEIGHT);
+        ASSERT(MinutesToWeight(std::numeric_limits<double>::max()) == transport::UNREACHABLE_WEIGHT);
+        ASSERT(MinutesToWeight(-5.0) == transport::Weight{});
+        ASSERT(MinutesToWeight(1e9) < transport::UNREACHABLE_WEIGHT);
+    }
+    ASSERT(std::abs(transport::WeightToMinutes(MinutesToWeight(12.5)) - 12.5) < 1e-9);
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestZeroMaxTime);
+    RUN_TEST(TestUnknownStop);
+    RUN_TEST(TestIsolatedStop);
+    RUN_TEST(TestUnboundedMaxTime);
+    RUN_TEST(TestMinutesToWeightRange);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
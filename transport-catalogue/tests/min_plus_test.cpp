@@ -0,0 +1,211 @@
+#include "test_framework.h"
+
+#include "min_plus.h"
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+using graph::min_plus_detail::NONE_EDGE;
+using graph::min_plus_detail::UNREACHABLE_WEIGHT;
+
+// Строка таблицы маршрутов и строка опорной вершины
+template <typename Weight, typename EdgeIndex>
+struct RowData {
+    std::vector<Weight> weights;
+    std::vector<EdgeIndex> prev_edges;
+    std::vector<Weight> pivot_weights;
+    std::vector<EdgeIndex> pivot_prev_edges;
+    Weight weight_from{};
+    EdgeIndex prev_edge_from{};
+};
+
+template <typename Weight, typename EdgeIndex>
+using RelaxFunction = std::function<void(Weight*, EdgeIndex*, Weight, EdgeIndex, const Weight*, const EdgeIndex*, size_t)>;
+
+// Эталонная релаксация с ветвлениями, которую заменили ядра
+template <typename Weight, typename EdgeIndex>
+void RelaxReference(Weight* weights, EdgeIndex* prev_edges, Weight weight_from, EdgeIndex prev_edge_from,
+                    const Weight* pivot_weights, const EdgeIndex* pivot_prev_edges, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (pivot_weights[i] == UNREACHABLE_WEIGHT<Weight>) {
+            continue;
+        }
+
+        const Weight candidate_weight = weight_from + pivot_weights[i];
+        if (candidate_weight < weights[i]) {
+            weights[i] = candidate_weight;
+            prev_edges[i] = pivot_prev_edges[i] != NONE_EDGE<EdgeIndex> ? pivot_prev_edges[i] : prev_edge_from;
+        }
+    }
+}
+
+// Вес из небольшого набора значений, чтобы суммы часто совпадали с текущими весами,
+// и каждый пятый вес недостижим
+template <typename Weight>
+Weight MakeWeight(std::mt19937& generator) {
+    const unsigned value = std::uniform_int_distribution<unsigned>(0, 19)(generator);
+    if (value % 5 == 0) {
+        return UNREACHABLE_WEIGHT<Weight>;
+    }
+
+    if constexpr (std::is_floating_point_v<Weight>) {
+        return static_cast<Weight>(value) * Weight(0.5);
+    }
+    else {
+        return static_cast<Weight>(value) * 500000;
+    }
+}
+
+// Каждое третье ребро отсутствует
+template <typename EdgeIndex>
+EdgeIndex MakeEdge(std::mt19937& generator) {
+    const unsigned value = std::uniform_int_distribution<unsigned>(0, 2999)(generator);
+
+    return value % 3 == 0 ? NONE_EDGE<EdgeIndex> : static_cast<EdgeIndex>(value);
+}
+
+template <typename Weight, typename EdgeIndex>
+RowData<Weight, EdgeIndex> MakeRow(std::mt19937& generator, size_t count) {
+    RowData<Weight, EdgeIndex> row;
+    for (size_t i = 0; i < count; ++i) {
+        row.weights.push_back(MakeWeight<Weight>(generator));
+        row.prev_edges.push_back(MakeEdge<EdgeIndex>(generator));
+        row.pivot_weights.push_back(MakeWeight<Weight>(generator));
+        row.pivot_prev_edges.push_back(MakeEdge<EdgeIndex>(generator));
+    }
+
+    do {
+        row.weight_from = MakeWeight<Weight>(generator);
+    } while (row.weight_from == UNREACHABLE_WEIGHT<Weight>);
+    row.prev_edge_from = static_cast<EdgeIndex>(std::uniform_int_distribution<unsigned>(0, 2999)(generator));
+
+    return row;
+}
+
+// Функция применяет релаксацию к строке, начиная с ячейки offset, чтобы проверить
+// и невыровненные адреса, и сравнивает результат с эталоном
+template <typename Weight, typename EdgeIndex>
+bool IsSameAsReference(const RowData<Weight, EdgeIndex>& row, size_t offset, const RelaxFunction<Weight, EdgeIndex>& relax) {
+    const size_t count = row.weights.size() - offset;
+
+    RowData<Weight, EdgeIndex> expected = row;
+    RelaxReference(expected.weights.data() + offset, expected.prev_edges.data() + offset, row.weight_from, row.prev_edge_from,
+                   row.pivot_weights.data() + offset, row.pivot_prev_edges.data() + offset, count);
+
+    RowData<Weight, EdgeIndex> actual = row;
+    relax(actual.weights.data() + offset, actual.prev_edges.data() + offset, row.weight_from, row.prev_edge_from,
+          row.pivot_weights.data() + offset, row.pivot_prev_edges.data() + offset, count);
+
+    return actual.weights == expected.weights && actual.prev_edges == expected.prev_edges;
+}
+
+// Строки длиной от 0 до 37 ячеек: длины, не кратные ширине векторов, проверяют скалярный остаток
+template <typename Weight, typename EdgeIndex>
+void CheckRandomRows(const RelaxFunction<Weight, EdgeIndex>& relax, const std::string& hint) {
+    std::mt19937 generator(1);
+    size_t mismatch_count = 0;
+
+    for (size_t count = 0; count < 38; ++count) {
+        for (int repeat = 0; repeat < 200; ++repeat) {
+            const RowData<Weight, EdgeIndex> row = MakeRow<Weight, EdgeIndex>(generator, count + 1);
+            mismatch_count += !IsSameAsReference(row, 0, relax);
+            mismatch_count += !IsSameAsReference(row, 1, relax);
+        }
+    }
+
+    ASSERT_EQUAL_HINT(mismatch_count, size_t{ 0 }, hint);
+}
+
+// Особые случаи: равный путь не заменяет ребро, путь через недостижимую ячейку
+// не принимается даже при переполнении суммы, недостижимая ячейка строки становится достижимой
+template <typename Weight, typename EdgeIndex>
+void CheckSpecialRows(const RelaxFunction<Weight, EdgeIndex>& relax, const std::string& hint) {
+    const Weight unreachable = UNREACHABLE_WEIGHT<Weight>;
+    const EdgeIndex none = NONE_EDGE<EdgeIndex>;
+
+    RowData<Weight, EdgeIndex> row;
+    row.weight_from = Weight(3);
+    row.prev_edge_from = EdgeIndex(7);
+    row.weights = { Weight(5), unreachable, Weight(9), Weight(1), unreachable, Weight(4), Weight(6) };
+    row.prev_edges = { EdgeIndex(1), none, EdgeIndex(2), EdgeIndex(3), none, EdgeIndex(4), EdgeIndex(5) };
+    row.pivot_weights = { Weight(2), Weight(1), unreachable, Weight(0), unreachable, Weight(0), Weight(2) };
+    row.pivot_prev_edges = { EdgeIndex(11), none, EdgeIndex(12), EdgeIndex(13), none, none, EdgeIndex(15) };
+
+    for (size_t offset = 0; offset < row.weights.size(); ++offset) {
+        ASSERT_HINT(IsSameAsReference(row, offset, relax), hint + ", offset "s + std::to_string(offset));
+    }
+
+    RowData<Weight, EdgeIndex> relaxed = row;
+    relax(relaxed.weights.data(), relaxed.prev_edges.data(), row.weight_from, row.prev_edge_from,
+          row.pivot_weights.data(), row.pivot_prev_edges.data(), row.weights.size());
+    ASSERT_HINT(relaxed.weights[0] == Weight(5) && relaxed.prev_edges[0] == EdgeIndex(1), hint + ": tie"s);
+    ASSERT_HINT(relaxed.weights[1] == Weight(4) && relaxed.prev_edges[1] == EdgeIndex(7), hint + ": unreachable cell"s);
+    ASSERT_HINT(relaxed.weights[2] == Weight(9) && relaxed.prev_edges[2] == EdgeIndex(2), hint + ": unreachable pivot"s);
+    ASSERT_HINT(relaxed.weights[4] == unreachable && relaxed.prev_edges[4] == none, hint + ": both unreachable"s);
+    ASSERT_HINT(relaxed.weights[5] == Weight(3) && relaxed.prev_edges[5] == EdgeIndex(7), hint + ": empty pivot path"s);
+}
+
+template <typename Weight, typename EdgeIndex>
+void CheckKernel(const RelaxFunction<Weight, EdgeIndex>& relax, const std::string& kernel) {
+    const std::string hint = kernel + ", "s + (std::is_floating_point_v<Weight> ? "double"s : "uint64_t"s)
+                             + " weights, "s + std::to_string(sizeof(EdgeIndex) * 8) + "-bit edges"s;
+
+    CheckRandomRows(relax, hint);
+    CheckSpecialRows(relax, hint);
+}
+
+// Проверка всех ядер, которые поддерживает процессор, и выбора ядра для одного сочетания типов
+template <typename Weight, typename EdgeIndex>
+void CheckKernels() {
+    CheckKernel<Weight, EdgeIndex>([](Weight* weights, EdgeIndex* prev_edges, Weight weight_from, EdgeIndex prev_edge_from,
+                                      const Weight* pivot_weights, const EdgeIndex* pivot_prev_edges, size_t count) {
+        graph::min_plus_detail::RelaxRowScalar(weights, prev_edges, weight_from, prev_edge_from,
+                                               pivot_weights, pivot_prev_edges, 0, count);
+    }, "scalar"s);
+
+#ifdef GRAPH_MIN_PLUS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        CheckKernel<Weight, EdgeIndex>(graph::min_plus_detail::RelaxRowSse42<Weight, EdgeIndex>, "sse4.2"s);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        CheckKernel<Weight, EdgeIndex>(graph::min_plus_detail::RelaxRowAvx2<Weight, EdgeIndex>, "avx2"s);
+    }
+#endif
+
+    CheckKernel<Weight, EdgeIndex>(graph::RelaxMinPlusRow<Weight, EdgeIndex>, "dispatch"s);
+}
+
+void TestMinutesKernels() {
+    CheckKernels<double, uint32_t>();
+    CheckKernels<double, uint16_t>();
+}
+
+void TestMicrosecondsKernels() {
+    CheckKernels<uint64_t, uint32_t>();
+    CheckKernels<uint64_t, uint16_t>();
+}
+
+// Для типов без векторных ядер выбирается скалярная релаксация
+void TestScalarFallback() {
+    CheckKernel<float, uint32_t>(graph::RelaxMinPlusRow<float, uint32_t>, "dispatch"s);
+    CheckKernel<uint32_t, uint64_t>(graph::RelaxMinPlusRow<uint32_t, uint64_t>, "dispatch"s);
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestMinutesKernels);
+    RUN_TEST(TestMicrosecondsKernels);
+    RUN_TEST(TestScalarFallback);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
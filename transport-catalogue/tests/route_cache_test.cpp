@@ -0,0 +1,144 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "lru_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// Ёмкость считается в единицах стоимости: при превышении вытесняются
+// давно не использованные элементы, а обращение делает элемент "свежим"
+void TestLruEviction() {
+    cache::LruCache<int, std::string> lru(10);
+    lru.Put(1, "one"s, 4);
+    lru.Put(2, "two"s, 4);
+    ASSERT_EQUAL(lru.GetSize(), size_t{ 8 });
+
+    ASSERT(lru.Get(1) == "one"s);
+    lru.Put(3, "three"s, 4);
+    ASSERT_EQUAL(lru.GetSize(), size_t{ 8 });
+    ASSERT(!lru.Get(2));
+    ASSERT(lru.Get(1) == "one"s);
+    ASSERT(lru.Get(3) == "three"s);
+
+    // Замена элемента учитывает его новую стоимость
+    lru.Put(1, "uno"s, 6);
+    ASSERT_EQUAL(lru.GetSize(), size_t{ 10 });
+    ASSERT(lru.Get(1) == "uno"s);
+
+    // Элемент дороже всей ёмкости не добавляется и ничего не вытесняет
+    lru.Put(4, "four"s, 11);
+    ASSERT(!lru.Get(4));
+    ASSERT_EQUAL(lru.GetSize(), size_t{ 10 });
+
+    cache::LruCache<int, std::string> empty(0);
+    empty.Put(1, "one"s, 1);
+    ASSERT(!empty.Get(1));
+    ASSERT_EQUAL(empty.GetSize(), size_t{ 0 });
+}
+
+// Функция строит базу с заданным объёмом кэша ответов
+std::unique_ptr<tests::TestBase> MakeCacheBase(int route_cache_size) {
+    tests::NetworkOptions options;
+    options.seed = 10;
+    options.routing_settings = "\"route_cache_size\": "s + std::to_string(route_cache_size);
+
+    return tests::MakeBase(tests::MakeNetwork(options));
+}
+
+// Функция возвращает пары остановок, между которыми есть непустые маршруты
+std::vector<std::pair<const transport::Stop*, const transport::Stop*>> FindRoutePairs(const tests::TestBase& base, size_t count) {
+    std::vector<std::pair<const transport::Stop*, const transport::Stop*>> result;
+
+    for (const transport::Stop& from : base.db.GetAllStops()) {
+        for (const transport::Stop& to : base.db.GetAllStops()) {
+            const auto route = base.router->GetRouteInfo(&from, &to);
+            if (route && !route->edges.empty() && result.size() < count) {
+                result.push_back({ &from, &to });
+            }
+        }
+    }
+
+    return result;
+}
+
+// Маршруты вытесняются из кэша, когда их суммарный размер превышает объём в байтах
+void TestRouteCacheByteLimit() {
+    constexpr int CACHE_SIZE = 1024;
+    const auto base = MakeCacheBase(CACHE_SIZE);
+    const auto pairs = FindRoutePairs(*base, 20);
+    ASSERT_EQUAL(pairs.size(), size_t{ 20 });
+
+    for (const auto& [from, to] : pairs) {
+        base->router->CacheRoute(from, to, *base->router->GetRouteInfo(from, to));
+
+        const json::Dict stats = base->router->GetStats().AsDict();
+        ASSERT(stats.at("route_cache_size"s).AsInt() <= CACHE_SIZE);
+    }
+
+    ASSERT(base->router->FindCachedRoute(pairs.back().first, pairs.back().second));
+    ASSERT(!base->router->FindCachedRoute(pairs.front().first, pairs.front().second));
+    ASSERT(base->router->GetStats().AsDict().at("route_cache_size"s).AsInt() > 0);
+}
+
+// При нулевом объёме кэш не хранит маршрутов
+void TestDisabledRouteCache() {
+    const auto base = MakeCacheBase(0);
+    const auto pairs = FindRoutePairs(*base, 5);
+
+    for (const auto& [from, to] : pairs) {
+        base->router->CacheRoute(from, to, *base->router->GetRouteInfo(from, to));
+        ASSERT(!base->router->FindCachedRoute(from, to));
+    }
+
+    const json::Dict stats = base->router->GetStats().AsDict();
+    ASSERT_EQUAL(stats.at("route_cache_size"s).AsInt(), 0);
+    ASSERT_EQUAL(stats.at("route_cache_hits"s).AsInt(), 0);
+}
+
+// Маршрут из кэша совпадает с построенным заново, а ответы на пакет с повторяющимися
+// запросами не зависят от того, включён ли кэш
+void TestCachedRoutesMatchFresh() {
+    const auto base = MakeCacheBase(1 << 20);
+    for (const auto& [from, to] : FindRoutePairs(*base, 10)) {
+        const auto fresh = base->router->GetRouteInfo(from, to);
+        base->router->CacheRoute(from, to, *fresh);
+        const auto cached = base->router->FindCachedRoute(from, to);
+
+        ASSERT(cached && cached->weight == fresh->weight && cached->edges.size() == fresh->edges.size());
+        for (size_t i = 0; cached && i < cached->edges.size() && i < fresh->edges.size(); ++i) {
+            ASSERT(cached->edges[i].from == fresh->edges[i].from && cached->edges[i].to == fresh->edges[i].to
+                   && cached->edges[i].item_id == fresh->edges[i].item_id && cached->edges[i].weight == fresh->edges[i].weight);
+        }
+    }
+
+    std::vector<std::pair<size_t, size_t>> route_pairs;
+    for (size_t round = 0; round < 3; ++round) {
+        for (size_t from = 0; from < 10; ++from) {
+            route_pairs.push_back({ from, (from * 7 + 3) % 40 });
+        }
+    }
+    const json::Array requests = tests::MakeRouteRequests(route_pairs);
+
+    const auto cached_base = MakeCacheBase(1 << 20);
+    const std::string answer = tests::Respond(*cached_base, requests);
+    ASSERT(answer == tests::Respond(*MakeCacheBase(0), requests));
+    ASSERT(cached_base->router->GetStats().AsDict().at("route_cache_hits"s).AsInt() > 0);
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestLruEviction);
+    RUN_TEST(TestRouteCacheByteLimit);
+    RUN_TEST(TestDisabledRouteCache);
+    RUN_TEST(TestCachedRoutesMatchFresh);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
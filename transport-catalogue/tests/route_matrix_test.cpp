@@ -0,0 +1,144 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t STOP_COUNT = 24;
+const std::string UNKNOWN_STOP = "Unknown stop"s;
+
+// Остановки отправления матрицы: повторяющаяся остановка и неизвестная остановка
+// проверяют переиспользование строк и пустые строки
+const std::vector<std::string> SOURCES = { tests::GetTestStopName(0), tests::GetTestStopName(1), UNKNOWN_STOP,
+                                           tests::GetTestStopName(5), tests::GetTestStopName(0) };
+
+// Остановки прибытия: все остановки сети и неизвестная остановка
+std::vector<std::string> MakeTargets() {
+    std::vector<std::string> targets;
+    for (size_t stop = 0; stop < STOP_COUNT; ++stop) {
+        targets.push_back(tests::GetTestStopName(stop));
+    }
+    targets.insert(targets.begin() + 3, UNKNOWN_STOP);
+
+    return targets;
+}
+
+json::Array ToArray(const std::vector<std::string>& names) {
+    json::Array result;
+    for (const std::string& name : names) {
+        result.push_back(name);
+    }
+
+    return result;
+}
+
+// Функция отвечает на запрос RouteMatrix и запросы Route для каждой ячейки матрицы
+json::Array RespondMatrixAndRoutes(const std::string& routing_settings) {
+    tests::NetworkOptions options;
+    options.stop_count = STOP_COUNT;
+    options.bus_count = 10;
+    options.seed = 12;
+    options.town_count = 2;
+    options.routing_settings = routing_settings;
+    const auto base = tests::MakeBase(tests::MakeNetwork(options));
+
+    const std::vector<std::string> targets = MakeTargets();
+    json::Array requests{ json::Dict{ { "id"s, 0 }, { "type"s, "RouteMatrix"s },
+                                      { "from"s, ToArray(SOURCES) }, { "to"s, ToArray(targets) } } };
+    for (const std::string& from : SOURCES) {
+        for (const std::string& to : targets) {
+            requests.push_back(json::Dict{ { "id"s, static_cast<int>(requests.size()) }, { "type"s, "Route"s },
+                                           { "from"s, from }, { "to"s, to } });
+        }
+    }
+
+    std::istringstream output(tests::Respond(*base, requests));
+
+    return json::Load(output).GetRoot().AsArray();
+}
+
+// Ячейка матрицы равна времени маршрута из отдельного запроса Route,
+// а для ненайденного маршрута и неизвестной остановки равна null
+void CheckMatrix(const std::string& algorithm) {
+    const json::Array answers = RespondMatrixAndRoutes("\"routing_algorithm\": \""s + algorithm + "\""s);
+    const std::vector<std::string> targets = MakeTargets();
+
+    const json::Dict& matrix_answer = answers.front().AsDict();
+    ASSERT_EQUAL_HINT(matrix_answer.at("request_id"s).AsInt(), 0, algorithm);
+    const json::Array& matrix = matrix_answer.at("total_time"s).AsArray();
+    ASSERT_EQUAL_HINT(matrix.size(), SOURCES.size(), algorithm);
+
+    size_t null_count = 0;
+    size_t zero_count = 0;
+    size_t mismatch_count = 0;
+    for (size_t row = 0; row < matrix.size(); ++row) {
+        const json::Array& times = matrix[row].AsArray();
+        ASSERT_EQUAL_HINT(times.size(), targets.size(), algorithm);
+
+        for (size_t column = 0; column < times.size() && column < targets.size(); ++column) {
+            const json::Dict& route = answers[1 + row * targets.size() + column].AsDict();
+
+            if (times[column].IsNull()) {
+                ++null_count;
+                mismatch_count += route.count("total_time"s);
+                continue;
+            }
+
+            mismatch_count += !route.count("total_time"s)
+                              || std::abs(route.at("total_time"s).AsDouble() - times[column].AsDouble()) > 1e-6;
+            if (SOURCES[row] == targets[column]) {
+                zero_count += times[column].AsDouble() == 0.0;
+            }
+        }
+    }
+
+    ASSERT_EQUAL_HINT(mismatch_count, size_t{ 0 }, algorithm);
+    ASSERT_EQUAL_HINT(zero_count, size_t{ 4 }, algorithm);
+    // Строка неизвестной остановки, столбцы неизвестной остановки и остановки другого города
+    ASSERT_HINT(null_count > targets.size() + SOURCES.size(), algorithm);
+    ASSERT_HINT(matrix[0] == matrix[4], algorithm);
+}
+
+void TestAllPairsMatrix() {
+    CheckMatrix("all_pairs"s);
+}
+
+void TestDijkstraMatrix() {
+    CheckMatrix("dijkstra"s);
+}
+
+void TestAltMatrix() {
+    CheckMatrix("alt"s);
+}
+
+void TestContractionHierarchiesMatrix() {
+    CheckMatrix("contraction_hierarchies"s);
+}
+
+void TestHubLabelsMatrix() {
+    CheckMatrix("hub_labels"s);
+}
+
+void TestRaptorMatrix() {
+    CheckMatrix("raptor"s);
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestAllPairsMatrix);
+    RUN_TEST(TestDijkstraMatrix);
+    RUN_TEST(TestAltMatrix);
+    RUN_TEST(TestContractionHierarchiesMatrix);
+    RUN_TEST(TestHubLabelsMatrix);
+    RUN_TEST(TestRaptorMatrix);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// Сеть из трёх несвязанных городов, в которой часть маршрутов повторяет другие,
+// поэтому в ней есть и недостижимые пары остановок, и равные по времени пути
+tests::NetworkOptions MakeTiedNetworkOptions(const std::string& routing_settings) {
+    tests::NetworkOptions options;
+    options.stop_count = 45;
+    options.bus_count = 18;
+    options.tied_bus_count = 6;
+    options.seed = 21;
+    options.town_count = 3;
+    options.routing_settings = routing_settings;
+
+    return options;
+}
+
+// Функция отвечает на запросы Route между всеми парами остановок, включая совпадающие
+std::string RespondAllStopPairs(const tests::NetworkOptions& options) {
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t from = 0; from < options.stop_count; ++from) {
+        for (size_t to = 0; to < options.stop_count; ++to) {
+            pairs.push_back({ from, to });
+        }
+    }
+
+    return tests::Respond(*tests::MakeBase(tests::MakeNetwork(options)), tests::MakeRouteRequests(pairs));
+}
+
+// Функция сравнивает время маршрутов в двух ответах: маршрут должен быть найден
+// в обоих ответах или не найден ни в одном, а время - совпадать
+void CheckSameTotalTimes(const std::string& answer, const std::string& expected_answer, const std::string& hint) {
+    std::istringstream input(answer);
+    std::istringstream expected_input(expected_answer);
+    const json::Array answers = json::Load(input).GetRoot().AsArray();
+    const json::Array expected = json::Load(expected_input).GetRoot().AsArray();
+    ASSERT_EQUAL_HINT(answers.size(), expected.size(), hint);
+
+    size_t mismatch_count = 0;
+    size_t unreachable_count = 0;
+    for (size_t i = 0; i < answers.size() && i < expected.size(); ++i) {
+        const json::Dict& route = answers[i].AsDict();
+        const json::Dict& expected_route = expected[i].AsDict();
+
+        if (route.count("total_time"s) != expected_route.count("total_time"s)) {
+            ++mismatch_count;
+        }
+        else if (!expected_route.count("total_time"s)) {
+            ++unreachable_count;
+        }
+        else if (std::abs(route.at("total_time"s).AsDouble() - expected_route.at("total_time"s).AsDouble()) > 1e-6) {
+            ++mismatch_count;
+        }
+    }
+
+    ASSERT_EQUAL_HINT(mismatch_count, size_t{ 0 }, hint);
+    ASSERT_HINT(unreachable_count > 0, hint + ": network has no unreachable pairs"s);
+}
+
+// По умолчанию маршруты строятся по таблице всех пар, поэтому ответы, в том числе
+// выбор автобуса среди равных по времени путей, не отличаются от прежних
+void TestDefaultAlgorithm() {
+    const std::string expected = RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"all_pairs\""s));
+
+    ASSERT(RespondAllStopPairs(MakeTiedNetworkOptions(""s)) == expected);
+}
+
+// Таблица графа с одной вершиной на остановку выбирает среди равных по времени путей
+// те же автобусы и участки, что и таблица графа с вершинами ожидания и отправления.
+// В этих сетях выбор расходился, пока ожидание и время поездки складывались заранее
+void TestFoldedWaitVertices() {
+    for (const uint32_t seed : { 3u, 4u, 7u }) {
+        tests::NetworkOptions options = MakeTiedNetworkOptions("\"routing_algorithm\": \"all_pairs\""s);
+        options.seed = seed;
+        const std::string expected = RespondAllStopPairs(options);
+
+        options.routing_settings += ", \"fold_wait_vertices\": true"s;
+        ASSERT_HINT(RespondAllStopPairs(options) == expected, "seed "s + std::to_string(seed));
+    }
+}
+
+// Поиск Дейкстры находит пути того же времени; среди равных путей он может выбрать другой
+void TestDijkstraTotalTimes() {
+    const std::string expected = RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"all_pairs\""s));
+
+    CheckSameTotalTimes(RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"dijkstra\""s)),
+                        expected, "dijkstra"s);
+}
+
+// Сжатие графа добавляет сокращающие рёбра, но не меняет время кратчайших путей
+void TestContractionHierarchiesTotalTimes() {
+    const std::string expected = RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"all_pairs\""s));
+
+    CheckSameTotalTimes(RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"contraction_hierarchies\""s)),
+                        expected, "contraction_hierarchies"s);
+}
+
+// У остановок разных городов нет общих хабов, и маршрут между ними не находится
+void TestHubLabelsTotalTimes() {
+    const std::string expected = RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"all_pairs\""s));
+
+    CheckSameTotalTimes(RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"hub_labels\""s)),
+                        expected, "hub_labels"s);
+}
+
+// Функция считает маршруты ответа, в которых больше одной поездки на автобусе
+size_t CountTransferRoutes(const std::string& answer) {
+    std::istringstream input(answer);
+    const json::Document document = json::Load(input);
+    size_t count = 0;
+
+    for (const json::Node& route : document.GetRoot().AsArray()) {
+        if (!route.AsDict().count("items"s)) {
+            continue;
+        }
+
+        size_t bus_count = 0;
+        for (const json::Node& item : route.AsDict().at("items"s).AsArray()) {
+            bus_count += item.AsDict().at("type"s).AsString() == "Bus"s;
+        }
+        count += bus_count > 1;
+    }
+
+    return count;
+}
+
+// Поиск по расписанию маршрутов (RAPTOR) находит пути того же времени, что и поиск по графу,
+// в том числе с пересадками и поездками по кольцевым маршрутам
+void TestRaptorTotalTimes() {
+    const tests::NetworkOptions options = MakeTiedNetworkOptions("\"routing_algorithm\": \"raptor\""s);
+    const std::string answer = RespondAllStopPairs(options);
+
+    CheckSameTotalTimes(answer, RespondAllStopPairs(MakeTiedNetworkOptions("\"routing_algorithm\": \"dijkstra\""s)),
+                        "raptor"s);
+    ASSERT(CountTransferRoutes(answer) > 0);
+
+    const json::Document network = tests::MakeNetwork(options);
+    size_t roundtrip_count = 0;
+    for (const json::Node& request : network.GetRoot().AsDict().at("base_requests"s).AsArray()) {
+        const json::Dict& dict = request.AsDict();
+        roundtrip_count += dict.at("type"s).AsString() == "Bus"s && dict.at("is_roundtrip"s).AsBool();
+    }
+    ASSERT(roundtrip_count > 0);
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestDefaultAlgorithm);
+    RUN_TEST(TestFoldedWaitVertices);
+    RUN_TEST(TestDijkstraTotalTimes);
+    RUN_TEST(TestContractionHierarchiesTotalTimes);
+    RUN_TEST(TestHubLabelsTotalTimes);
+    RUN_TEST(TestRaptorTotalTimes);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "test_framework.h"
+#include "test_network.h"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t STOP_COUNT = 40;
+
+// Функция отвечает на пакет запросов Route от одной остановки до всех остальных
+// с запросом RoutingStats в конце и возвращает разобранный ответ
+json::Array RespondSharedOrigin(const std::string& routing_settings) {
+    tests::NetworkOptions options;
+    options.stop_count = STOP_COUNT;
+    options.seed = 7;
+    options.routing_settings = routing_settings;
+    const auto base = tests::MakeBase(tests::MakeNetwork(options));
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t to = 1; to < STOP_COUNT; ++to) {
+        pairs.push_back({ 0, to });
+    }
+    json::Array requests = tests::MakeRouteRequests(pairs);
+    requests.push_back(json::Dict{ { "id"s, static_cast<int>(pairs.size()) }, { "type"s, "RoutingStats"s } });
+
+    std::istringstream output(tests::Respond(*base, requests));
+
+    return json::Load(output).GetRoot().AsArray();
+}
+
+// Поиск по запросу должен учитывать каждый маршрут пакета с общей остановкой отправления
+void TestSharedOriginStats(const std::string& algorithm) {
+    const json::Array answers = RespondSharedOrigin("\"routing_algorithm\": \""s + algorithm + "\""s);
+    const json::Dict& stats = answers.back().AsDict();
+
+    ASSERT_EQUAL(stats.at("routing_algorithm"s).AsString(), algorithm);
+    ASSERT_EQUAL_HINT(stats.at("route_queries"s).AsInt(), static_cast<int>(STOP_COUNT - 1), algorithm);
+    ASSERT_HINT(stats.at("settled_vertices"s).AsInt() > 0, algorithm);
+}
+
+void TestAltSharedOriginStats() {
+    TestSharedOriginStats("alt"s);
+}
+
+void TestDijkstraSharedOriginStats() {
+    TestSharedOriginStats("dijkstra"s);
+}
+
+// Запрос статистики получает счётчики поиска только для предшествующих ему запросов,
+// хотя маршруты группируются по остановке отправления до вывода ответов
+void TestStatsPosition() {
+    for (const std::string& algorithm : { "alt"s, "dijkstra"s }) {
+        tests::NetworkOptions options;
+        options.stop_count = STOP_COUNT;
+        options.seed = 7;
+        options.routing_settings = "\"routing_algorithm\": \""s + algorithm + "\""s;
+        const auto base = tests::MakeBase(tests::MakeNetwork(options));
+
+        json::Array requests;
+        for (size_t part = 0; part < 3; ++part) {
+            requests.push_back(json::Dict{ { "id"s, static_cast<int>(requests.size()) }, { "type"s, "RoutingStats"s } });
+            for (size_t to = 1; part < 2 && to <= 10; ++to) {
+                requests.push_back(json::Dict{ { "id"s, static_cast<int>(requests.size()) }, { "type"s, "Route"s },
+                                               { "from"s, tests::GetTestStopName(0) },
+                                               { "to"s, tests::GetTestStopName(part * 10 + to) } });
+            }
+        }
+
+        std::istringstream output(tests::Respond(*base, requests));
+        const json::Array answers = json::Load(output).GetRoot().AsArray();
+
+        ASSERT_EQUAL_HINT(answers[0].AsDict().at("route_queries"s).AsInt(), 0, algorithm);
+        ASSERT_EQUAL_HINT(answers[0].AsDict().at("settled_vertices"s).AsInt(), 0, algorithm);
+        ASSERT_EQUAL_HINT(answers[11].AsDict().at("route_queries"s).AsInt(), 10, algorithm);
+        ASSERT_EQUAL_HINT(answers[22].AsDict().at("route_queries"s).AsInt(), 20, algorithm);
+    }
+}
+
+// Маршруты группы совпадают по времени с таблицей всех пар
+void TestSharedOriginRoutes() {
+    const json::Array expected = RespondSharedOrigin("\"routing_algorithm\": \"all_pairs\""s);
+
+    for (const std::string& algorithm : { "alt"s, "dijkstra"s }) {
+        const json::Array answers = RespondSharedOrigin("\"routing_algorithm\": \""s + algorithm + "\""s);
+
+        for (size_t i = 0; i + 1 < answers.size(); ++i) {
+            const json::Dict& answer = answers[i].AsDict();
+            const json::Dict& expected_answer = expected[i].AsDict();
+
+            ASSERT_EQUAL_HINT(answer.count("total_time"s), expected_answer.count("total_time"s), algorithm);
+            if (answer.count("total_time"s) && expected_answer.count("total_time"s)) {
+                ASSERT_HINT(std::abs(answer.at("total_time"s).AsDouble() - expected_answer.at("total_time"s).AsDouble()) < 1e-6,
+                            algorithm + " request "s + std::to_string(i));
+            }
+        }
+    }
+}
+
+} // end of namespace
+
+int main() {
+    RUN_TEST(TestAltSharedOriginStats);
+    RUN_TEST(TestDijkstraSharedOriginStats);
+    RUN_TEST(TestStatsPosition);
+    RUN_TEST(TestSharedOriginRoutes);
+
+    return TESTS_RESULT();
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace tests {
+
+// Количество проваленных проверок; программа теста возвращает ненулевой код, если оно больше нуля
+inline int& FailureCount() {
+    static int failure_count = 0;
+
+    return failure_count;
+}
+
+// Функция сообщает о проваленной проверке
+inline void ReportFailure(std::string_view expr, std::string_view file, int line, const std::string& hint) {
+    std::cerr << file << '(' << line << "): ASSERT(" << expr << ") failed";
+    if (!hint.empty()) {
+        std::cerr << ": " << hint;
+    }
+    std::cerr << std::endl;
+
+    ++FailureCount();
+}
+
+// Функция сообщает о несовпадении значений
+template <typename T, typename U>
+void AssertEqualImpl(const T& lhs, const U& rhs, std::string_view lhs_expr, std::string_view rhs_expr,
+                     std::string_view file, int line, const std::string& hint) {
+    if (!(lhs == rhs)) {
+        std::cerr << file << '(' << line << "): ASSERT_EQUAL(" << lhs_expr << ", " << rhs_expr << ") failed: "
+                  << lhs << " != " << rhs;
+        if (!hint.empty()) {
+            std::cerr << ": " << hint;
+        }
+        std::cerr << std::endl;
+
+        ++FailureCount();
+    }
+}
+
+// Функция запускает тест и сообщает о его результате
+template <typename Func>
+void RunTestImpl(Func func, std::string_view name) {
+    const int failures_before = FailureCount();
+    func();
+
+    if (FailureCount() == failures_before) {
+        std::cerr << name << " OK" << std::endl;
+    }
+    else {
+        std::cerr << name << " FAILED" << std::endl;
+    }
+}
+
+} // end of namespace tests
+
+#define ASSERT(expr) \
+    do { if (!(expr)) ::tests::ReportFailure(#expr, __FILE__, __LINE__, {}); } while (false)
+#define ASSERT_HINT(expr, hint) \
+    do { if (!(expr)) ::tests::ReportFailure(#expr, __FILE__, __LINE__, (hint)); } while (false)
+#define ASSERT_EQUAL(lhs, rhs) \
+    ::tests::AssertEqualImpl((lhs), (rhs), #lhs, #rhs, __FILE__, __LINE__, {})
+#define ASSERT_EQUAL_HINT(lhs, rhs, hint) \
+    ::tests::AssertEqualImpl((lhs), (rhs), #lhs, #rhs, __FILE__, __LINE__, (hint))
+#define RUN_TEST(func) ::tests::RunTestImpl((func), #func)
+#define TESTS_RESULT() (::tests::FailureCount() == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "json.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tests {
+
+// Параметры случайной сети маршрутов для тестов
+struct NetworkOptions {
+    size_t stop_count = 40;
+    size_t bus_count = 16;
+    uint32_t seed = 1;
+    // Наибольшее количество остановок маршрута в одну сторону
+    size_t max_bus_length = 9;
+    // Количество городов: остановка i относится к городу i % town_count, маршрут b проходит
+    // по остановкам города b % town_count, поэтому сети разных городов не связаны
+    size_t town_count = 1;
+    // Количество дополнительных маршрутов, повторяющих остановки первых маршрутов сети:
+    // маршрут b повторяет маршрут b - bus_count, поэтому между его остановками есть
+    // равные по времени пути на разных автобусах
+    size_t tied_bus_count = 0;
+    // Дополнительные поля "routing_settings" в виде фрагмента JSON, например "routing_algorithm": "alt"
+    std::string routing_settings;
+};
+
+// Функция возвращает название остановки сети по её номеру
+inline std::string GetTestStopName(size_t index) {
+    return "Stop " + std::to_string(index);
+}
+
+// Функция строит входной документ make_base со случайной сетью маршрутов.
+// Остановки и маршруты перечисляются в случайном порядке, а расстояния задаются
+// для каждой пары соседних остановок маршрута
+inline json::Document MakeNetwork(const NetworkOptions& options) {
+    std::mt19937 generator(options.seed);
+    auto random = [&generator](size_t bound) {
+        return std::uniform_int_distribution<size_t>(0, bound - 1)(generator);
+    };
+
+    std::vector<std::vector<size_t>> routes(options.bus_count + options.tied_bus_count);
+    std::vector<std::vector<std::pair<size_t, int>>> distances(options.stop_count);
+    std::vector<bool> is_roundtrip(routes.size());
+
+    const size_t town_stop_count = options.stop_count / options.town_count;
+    for (size_t bus = 0; bus < options.bus_count; ++bus) {
+        const size_t town = bus % options.town_count;
+        const size_t length = 2 + random(std::min(town_stop_count, options.max_bus_length) - 1);
+        std::vector<size_t>& route = routes[bus];
+        while (route.size() < length) {
+            const size_t stop = random(town_stop_count) * options.town_count + town;
+            if (std::find(route.begin(), route.end(), stop) == route.end()) {
+                route.push_back(stop);
+            }
+        }
+
+        is_roundtrip[bus] = random(3) == 0;
+        if (is_roundtrip[bus]) {
+            route.push_back(route.front());
+        }
+        for (size_t i = 0; i + 1 < route.size(); ++i) {
+            distances[route[i]].push_back({ route[i + 1], static_cast<int>(200 + random(3000)) });
+        }
+    }
+
+    for (size_t bus = options.bus_count; bus < routes.size(); ++bus) {
+        routes[bus] = routes[(bus - options.bus_count) % options.bus_count];
+        is_roundtrip[bus] = is_roundtrip[(bus - options.bus_count) % options.bus_count];
+    }
+
+    std::vector<std::string> requests;
+    for (size_t stop = 0; stop < options.stop_count; ++stop) {
+        std::ostringstream request;
+        request << R"({"type": "Stop", "name": ")" << GetTestStopName(stop)
+                << R"(", "latitude": )" << 55.6 + random(1000) * 0.0002
+                << R"(, "longitude": )" << 37.5 + random(1000) * 0.0002
+                << R"(, "road_distances": {)";
+
+        // Для пары остановок используется первое заданное расстояние
+        std::vector<size_t> seen;
+        for (const auto& [to, distance] : distances[stop]) {
+            if (std::find(seen.begin(), seen.end(), to) != seen.end()) {
+                continue;
+            }
+            request << (seen.empty() ? "" : ", ") << '"' << GetTestStopName(to) << "\": " << distance;
+            seen.push_back(to);
+        }
+        request << "}}";
+        requests.push_back(request.str());
+    }
+    for (size_t bus = 0; bus < routes.size(); ++bus) {
+        std::ostringstream request;
+        request << R"({"type": "Bus", "name": "Bus )" << bus << R"(", "is_roundtrip": )"
+                << (is_roundtrip[bus] ? "true" : "false") << R"(, "stops": [)";
+
+        // Некольцевой маршрут задаётся остановками в одну сторону
+        for (size_t i = 0; i < routes[bus].size(); ++i) {
+            request << (i == 0 ? "" : ", ") << '"' << GetTestStopName(routes[bus][i]) << '"';
+        }
+        request << "]}";
+        requests.push_back(request.str());
+    }
+    std::shuffle(requests.begin(), requests.end(), generator);
+
+    std::ostringstream input;
+    input << R"({"routing_settings": {"bus_wait_time": 4, "bus_velocity": 36)";
+    if (!options.routing_settings.empty()) {
+        input << ", " << options.routing_settings;
+    }
+    input << R"(}, "render_settings": {"width": 600, "height": 400, "padding": 50, "stop_radius": 5,
+        "line_width": 14, "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 20,
+        "stop_label_offset": [7, -3], "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+        "color_palette": ["green", [255, 160, 0], "red"]}, "base_requests": [)";
+    for (size_t i = 0; i < requests.size(); ++i) {
+        input << (i == 0 ? "" : ", ") << requests[i];
+    }
+    input << "]}";
+
+    std::istringstream stream(input.str());
+
+    return json::Load(stream);
+}
+
+// База, построенная так же, как при make_base
+struct TestBase {
+    transport::Catalogue db;
+    std::unique_ptr<transport::MapRenderer> renderer;
+    std::unique_ptr<transport::Router> router;
+};
+
+// Функция заполняет каталог и строит маршрутизатор по входному документу
+inline std::unique_ptr<TestBase> MakeBase(const json::Document& input) {
+    auto base = std::make_unique<TestBase>();
+    transport::JsonReader data(input);
+    data.ImportData(base->db);
+
+    base->renderer = std::make_unique<transport::MapRenderer>(data.SetRenderSettings(data.GetRenderSettingsData()));
+    base->router = std::make_unique<transport::Router>(data.SetRouterSettings(data.GetRoutingSettingsData()), base->db);
+
+    return base;
+}
+
+// Функция строит запросы Route между парами остановок с номерами запросов по порядку
+inline json::Array MakeRouteRequests(const std::vector<std::pair<size_t, size_t>>& pairs) {
+    json::Array requests;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        requests.push_back(json::Dict{
+            { "id", static_cast<int>(i) },
+            { "type", std::string("Route") },
+            { "from", GetTestStopName(pairs[i].first) },
+            { "to", GetTestStopName(pairs[i].second) }
+        });
+    }
+
+    return requests;
+}
+
+// Функция отвечает на пакет запросов и возвращает ответ в виде текста
+inline std::string Respond(const TestBase& base, const json::Array& requests) {
+    transport::RequestHandler handler(base.db, *base.renderer, *base.router);
+    std::ostringstream output;
+    handler.DatabaseRespond(json::Node(requests), output);
+
+    return output.str();
+}
+
+} // end of namespace tests
\ No newline at end of file
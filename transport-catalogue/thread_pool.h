@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Возвращает число потоков: заданное значение или количество ядер, если задан 0
+inline size_t ResolveThreadCount(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+    }
+
+    return std::max<size_t>(thread_count, 1);
+}
+
+// Пул потоков для параллельного выполнения независимых задач.
+// Вызывающий поток участвует в работе наравне с рабочими потоками
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count) {
+        const size_t worker_count = ResolveThreadCount(thread_count) - 1;
+        workers_.reserve(worker_count);
+
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers_.emplace_back([this] {
+                WorkerLoop();
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard guard(mutex_);
+            stopping_ = true;
+        }
+        wake_up_.notify_all();
+
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t GetThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    // Выполняет func(i) для всех i из [0, task_count) и дожидается завершения
+    template <typename Func>
+    void ParallelFor(size_t task_count, const Func& func) {
+        if (workers_.empty() || task_count <= 1) {
+            for (size_t i = 0; i < task_count; ++i) {
+                func(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard guard(mutex_);
+            task_ = [&func](size_t i) {
+                func(i);
+            };
+            task_count_ = task_count;
+            next_task_ = 0;
+            busy_workers_ = workers_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_up_.notify_all();
+
+        RunTasks();
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] {
+            return busy_workers_ == 0;
+        });
+        task_ = nullptr;
+
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    void WorkerLoop() {
+        size_t seen_generation = 0;
+
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                wake_up_.wait(lock, [this, seen_generation] {
+                    return stopping_ || generation_ != seen_generation;
+                });
+
+                if (stopping_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+
+            RunTasks();
+
+            std::lock_guard guard(mutex_);
+            if (--busy_workers_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    void RunTasks() {
+        for (size_t i = next_task_++; i < task_count_; i = next_task_++) {
+            try {
+                task_(i);
+            }
+            catch (...) {
+                std::lock_guard guard(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_up_;
+    std::condition_variable done_;
+    std::function<void(size_t)> task_;
+    size_t task_count_ = 0;
+    std::atomic<size_t> next_task_ = 0;
+    size_t busy_workers_ = 0;
+    size_t generation_ = 0;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+};
+
+} // end of namespace parallel
\ No newline at end of file
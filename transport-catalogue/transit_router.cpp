@@ -0,0 +1,275 @@
+#include "transit_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace transport {
+
+TransitRouter::TransitRouter(const Catalogue& db, int bus_wait_time, double bus_velocity)
+    : bus_wait_time_(MinutesToWeight(bus_wait_time)), bus_velocity_(bus_velocity)
+{
+    for (const Bus& bus : db.GetAllBuses()) {
+        AddBusSegments(bus);
+    }
+
+    IndexStopPositions(db.GetAllStops().size());
+}
+
+// Метод добавляет отрезки нового автобуса и перестраивает индекс вхождений остановок
+void TransitRouter::AddBus(const Bus& bus) {
+    const size_t stop_count = stop_positions_offsets_.size() - 1;
+
+    for (const Stop* stop : bus.stops) {
+        if (stop->id >= stop_count) {
+            throw std::out_of_range("Stop is out of range");
+        }
+    }
+
+    AddBusSegments(bus);
+    IndexStopPositions(stop_count);
+}
+
+// Метод удаляет отрезки автобуса, сдвигая отрезки остальных автобусов
+void TransitRouter::RemoveBus(const Bus& bus) {
+    std::vector<Segment> segments;
+    std::vector<uint32_t> segment_stops;
+    std::vector<int> segment_distances;
+
+    for (const Segment& segment : segments_) {
+        if (segment.bus_id == bus.id) {
+            continue;
+        }
+
+        const size_t begin = segment_stops.size();
+        segment_stops.insert(segment_stops.end(), segment_stops_.begin() + segment.begin, segment_stops_.begin() + segment.end);
+        segment_distances.insert(segment_distances.end(), segment_distances_.begin() + segment.begin,
+                                 segment_distances_.begin() + segment.end);
+        segments.push_back({ segment.bus_id, begin, segment_stops.size() });
+    }
+
+    segments_ = std::move(segments);
+    segment_stops_ = std::move(segment_stops);
+    segment_distances_ = std::move(segment_distances);
+    IndexStopPositions(stop_positions_offsets_.size() - 1);
+}
+
+// Метод добавляет отрезки маршрута автобуса
+void TransitRouter::AddBusSegments(const Bus& bus) {
+    const size_t stops_count = bus.stops.size();
+    const size_t final_index = stops_count / 2;
+
+    // Поездка на некольцевом маршруте не проходит через конечную остановку,
+    // как и рёбра графа маршрутов, поэтому маршрут делится на прямой и обратный отрезки
+    if (!bus.is_circular && stops_count > 0 && bus.stops[final_index] == bus.final_stop) {
+        AddSegment(bus, 0, final_index + 1);
+        AddSegment(bus, final_index, stops_count);
+    }
+    else {
+        AddSegment(bus, 0, stops_count);
+    }
+}
+
+// Метод строит индекс вхождений остановок в отрезки
+void TransitRouter::IndexStopPositions(size_t stop_count) {
+    stop_positions_offsets_.assign(stop_count + 1, 0);
+
+    for (const uint32_t stop_id : segment_stops_) {
+        ++stop_positions_offsets_[stop_id + 1];
+    }
+    for (size_t i = 0; i < stop_count; ++i) {
+        stop_positions_offsets_[i + 1] += stop_positions_offsets_[i];
+    }
+
+    std::vector<size_t> next(stop_positions_offsets_.begin(), stop_positions_offsets_.end() - 1);
+    stop_positions_.resize(segment_stops_.size());
+
+    for (size_t segment_id = 0; segment_id < segments_.size(); ++segment_id) {
+        for (size_t position = segments_[segment_id].begin; position < segments_[segment_id].end; ++position) {
+            stop_positions_[next[segment_stops_[position]]++] = { segment_id, position };
+        }
+    }
+}
+
+// Метод добавляет отрезок маршрута с расстояниями от его начала до каждой остановки
+void TransitRouter::AddSegment(const Bus& bus, size_t begin, size_t end) {
+    if (end - begin < 2) {
+        return;
+    }
+
+    const size_t offset = segment_stops_.size();
+    int distance = 0;
+
+    for (size_t i = begin; i < end; ++i) {
+        if (i > begin) {
+            distance += bus.stops[i - 1]->GetStopsDistance(bus.stops[i]);
+        }
+
+        segment_stops_.push_back(static_cast<uint32_t>(bus.stops[i]->id));
+        segment_distances_.push_back(distance);
+    }
+
+    segments_.push_back({ static_cast<uint32_t>(bus.id), offset, segment_stops_.size() });
+}
+
+// Метод вычисляет время поездки между позициями отрезка так же, как вес ребра графа маршрутов
+Weight TransitRouter::GetRideTime(size_t board, size_t alight) const {
+    return GetRideWeight(segment_distances_[alight] - segment_distances_[board], bus_velocity_);
+}
+
+// Метод возвращает маршрут с наименьшим временем между остановками
+std::optional<RouteInfo> TransitRouter::BuildRoute(const Stop* from, const Stop* to) const {
+    SearchState state;
+    Search(from->id, to->id, state);
+
+    return MakeRoute(from->id, to->id, state);
+}
+
+// Метод возвращает маршруты до нескольких остановок, выполняя один поиск без отсечения по цели
+std::vector<std::optional<RouteInfo>> TransitRouter::BuildRoutes(const Stop* from, const std::vector<const Stop*>& to) const {
+    SearchState state;
+    Search(from->id, NONE_STOP, state);
+
+    std::vector<std::optional<RouteInfo>> result;
+    result.reserve(to.size());
+
+    for (const Stop* stop : to) {
+        if (stop->id >= state.arrivals.size()) {
+            throw std::out_of_range("Stop is out of range");
+        }
+        result.push_back(MakeRoute(from->id, stop->id, state));
+    }
+
+    return result;
+}
+
+std::optional<RouteInfo> TransitRouter::MakeRoute(size_t from, size_t to, const SearchState& state) const {
+    if (state.arrivals[to] == UNREACHABLE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    // Восстановление маршрута от конечной остановки по последним поездкам
+    RouteInfo result{ state.arrivals[to], {} };
+
+    for (size_t stop = to; stop != from;) {
+        const Ride& ride = state.rides[stop];
+        const uint32_t board_stop = segment_stops_[ride.board];
+        const graph::VertexId board_vertex = board_stop * 2;
+
+        result.edges.push_back({ segments_[ride.segment].bus_id, static_cast<uint32_t>(ride.alight - ride.board),
+                                 board_vertex + 1, static_cast<graph::VertexId>(stop * 2),
+                                 GetRideTime(ride.board, ride.alight) });
+        result.edges.push_back({ board_stop, 0, board_vertex, board_vertex + 1, bus_wait_time_ });
+
+        stop = board_stop;
+    }
+    std::reverse(result.edges.begin(), result.edges.end());
+
+    return result;
+}
+
+// Метод рассчитывает время в пути до всех остановок одним поиском без отсечения по цели
+void TransitRouter::BuildTravelTimes(const Stop* from, const std::vector<const Stop*>& to,
+                                     SearchState& state, TravelTimes& times) const
+{
+    Search(from->id, NONE_STOP, state);
+
+    times.assign(to.size(), std::nullopt);
+    for (size_t i = 0; i < to.size(); ++i) {
+        if (to[i] && to[i]->id < state.arrivals.size() && state.arrivals[to[i]->id] != UNREACHABLE_WEIGHT) {
+            times[i] = state.arrivals[to[i]->id];
+        }
+    }
+}
+
+// Метод заполняет время прибытия на остановки, достижимые за ограниченное время
+void TransitRouter::BuildStopArrivals(const Stop* from, Weight max_weight, SearchState& state, StopArrivals& arrivals) const {
+    Search(from->id, NONE_STOP, state, max_weight);
+
+    arrivals.clear();
+    for (size_t stop = 0; stop < state.arrivals.size(); ++stop) {
+        if (state.arrivals[stop] != UNREACHABLE_WEIGHT && state.arrivals[stop] <= max_weight) {
+            arrivals.emplace_back(stop, state.arrivals[stop]);
+        }
+    }
+}
+
+void TransitRouter::Search(size_t from, size_t target, SearchState& state, Weight max_arrival) const {
+    const size_t stop_count = stop_positions_offsets_.size() - 1;
+
+    if (from >= stop_count || (target != NONE_STOP && target >= stop_count)) {
+        throw std::out_of_range("Stop is out of range");
+    }
+
+    state.arrivals.assign(stop_count, UNREACHABLE_WEIGHT);
+    state.rides.resize(stop_count);
+    state.is_marked.assign(stop_count, false);
+    state.marked_stops.assign(1, from);
+    state.first_positions.assign(segments_.size(), NONE_POSITION);
+    state.touched_segments.clear();
+    state.arrivals[from] = Weight{};
+
+    // Каждый раунд просматривает отрезки, проходящие через остановки,
+    // время прибытия на которые улучшилось в предыдущем раунде
+    while (!state.marked_stops.empty()) {
+        for (const size_t stop : state.marked_stops) {
+            state.is_marked[stop] = false;
+
+            for (size_t i = stop_positions_offsets_[stop]; i < stop_positions_offsets_[stop + 1]; ++i) {
+                const auto [segment_id, position] = stop_positions_[i];
+                size_t& first_position = state.first_positions[segment_id];
+
+                if (first_position == NONE_POSITION) {
+                    state.touched_segments.push_back(segment_id);
+                }
+                first_position = std::min(first_position, position);
+            }
+        }
+        state.marked_stops.clear();
+
+        for (const size_t segment_id : state.touched_segments) {
+            ScanSegment(segment_id, state.first_positions[segment_id], target, state, max_arrival);
+            state.first_positions[segment_id] = NONE_POSITION;
+        }
+        state.touched_segments.clear();
+    }
+}
+
+void TransitRouter::ScanSegment(size_t segment_id, size_t first_position, size_t target, SearchState& state,
+                                Weight max_arrival) const
+{
+    size_t board = NONE_POSITION;
+    Weight board_time = UNREACHABLE_WEIGHT;
+
+    for (size_t position = first_position; position < segments_[segment_id].end; ++position) {
+        const uint32_t stop = segment_stops_[position];
+        Weight on_board_time = UNREACHABLE_WEIGHT;
+
+        if (board != NONE_POSITION) {
+            on_board_time = board_time + GetRideTime(board, position);
+
+            // Поездки, прибывающие позже уже найденного времени до цели или позже
+            // ограничения времени в пути, отсекаются
+            if (on_board_time < state.arrivals[stop] && on_board_time <= max_arrival
+                && (target == NONE_STOP || on_board_time < state.arrivals[target]))
+            {
+                state.arrivals[stop] = on_board_time;
+                state.rides[stop] = { segment_id, board, position };
+
+                if (!state.is_marked[stop]) {
+                    state.is_marked[stop] = true;
+                    state.marked_stops.push_back(stop);
+                }
+                continue;
+            }
+        }
+
+        // Пересадка на этот же автобус выгоднее, если с учётом ожидания
+        // отправление с остановки происходит раньше, чем в текущей поездке
+        if (state.arrivals[stop] != UNREACHABLE_WEIGHT && state.arrivals[stop] + bus_wait_time_ < on_board_time) {
+            board = position;
+            board_time = state.arrivals[stop] + bus_wait_time_;
+        }
+    }
+}
+
+} // end of namespace transport
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "graph.h"
+#include "route_weight.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace transport {
+
+// Маршрут между остановками: общее время и последовательность ожиданий и поездок.
+// Каждый элемент представлен ребром графа маршрутов: ребро ожидания имеет
+// нулевое качество и номер остановки, ребро поездки - количество пролётов и номер автобуса
+struct RouteInfo {
+    Weight weight;
+    std::vector<graph::Edge<Weight>> edges;
+};
+
+// Время в пути от остановки до каждой из заданных остановок; отсутствие значения
+// означает, что остановка недостижима
+using TravelTimes = std::vector<std::optional<Weight>>;
+
+// Время прибытия на остановки, достижимые от остановки отправления за ограниченное время;
+// остановки задаются номерами в каталоге
+using StopArrivals = std::vector<std::pair<size_t, Weight>>;
+
+// Маршрутизатор, выполняющий поиск по раундам (RAPTOR) непосредственно по
+// последовательностям остановок маршрутов. Раунд k находит поездки ровно с k посадками,
+// поэтому не требуются ни рёбра для всех пар остановок, ни таблица всех пар вершин.
+// Время ожидания учитывается при каждой посадке, время поездки вычисляется
+// по дорожным расстояниям и скорости автобуса
+class TransitRouter {
+private:
+    static constexpr size_t NONE_POSITION = std::numeric_limits<size_t>::max();
+
+    // Последняя поездка, которой достигнута остановка
+    struct Ride {
+        size_t segment = 0;
+        size_t board = NONE_POSITION;
+        size_t alight = NONE_POSITION;
+    };
+
+public:
+    // Рабочие массивы поиска, которые можно переиспользовать между запросами
+    struct SearchState {
+        std::vector<Weight> arrivals;
+        std::vector<Ride> rides;
+        std::vector<bool> is_marked;
+        std::vector<size_t> marked_stops;
+        std::vector<size_t> first_positions;
+        std::vector<size_t> touched_segments;
+    };
+
+    TransitRouter(const Catalogue& db, int bus_wait_time, double bus_velocity);
+
+    // Добавление и удаление отрезков автобуса с перестроением индекса остановок.
+    // Остановки автобуса должны присутствовать в каталоге при создании маршрутизатора
+    void AddBus(const Bus& bus);
+    void RemoveBus(const Bus& bus);
+
+    std::optional<RouteInfo> BuildRoute(const Stop* from, const Stop* to) const;
+
+    // Маршруты от остановки до нескольких остановок по результатам одного поиска
+    std::vector<std::optional<RouteInfo>> BuildRoutes(const Stop* from, const std::vector<const Stop*>& to) const;
+
+    // Расчёт времени в пути от остановки до каждой из остановок to одним поиском
+    // без восстановления маршрутов. Неизвестные остановки передаются как nullptr
+    void BuildTravelTimes(const Stop* from, const std::vector<const Stop*>& to,
+                          SearchState& state, TravelTimes& times) const;
+
+    // Расчёт времени прибытия на остановки, достижимые от остановки не дольше max_weight.
+    // Поездки, прибывающие позже ограничения, отсекаются при поиске
+    void BuildStopArrivals(const Stop* from, Weight max_weight, SearchState& state, StopArrivals& arrivals) const;
+
+private:
+    static constexpr size_t NONE_STOP = std::numeric_limits<size_t>::max();
+
+    // Отрезок маршрута, по которому автобус едет без разворота.
+    // Некольцевой маршрут разбивается конечной остановкой на два отрезка
+    struct Segment {
+        uint32_t bus_id;
+        // Диапазон отрезка в общих массивах остановок и расстояний
+        size_t begin;
+        size_t end;
+    };
+
+    // Вхождение остановки в отрезок маршрута
+    struct StopPosition {
+        size_t segment;
+        size_t position;
+    };
+
+    void AddBusSegments(const Bus& bus);
+
+    void AddSegment(const Bus& bus, size_t begin, size_t end);
+
+    void IndexStopPositions(size_t stop_count);
+
+    // Поиск по раундам от остановки; при заданной цели поездки, не улучшающие
+    // время прибытия к ней, отсекаются, как и поездки, прибывающие позже max_arrival
+    void Search(size_t from, size_t target, SearchState& state, Weight max_arrival = UNREACHABLE_WEIGHT) const;
+
+    // Просмотр отрезка с первой отмеченной остановки с обновлением времени прибытия
+    void ScanSegment(size_t segment_id, size_t first_position, size_t target, SearchState& state,
+                     Weight max_arrival) const;
+
+    Weight GetRideTime(size_t board, size_t alight) const;
+
+    // Восстановление маршрута по последним поездкам после поиска
+    std::optional<RouteInfo> MakeRoute(size_t from, size_t to, const SearchState& state) const;
+
+    Weight bus_wait_time_;
+    double bus_velocity_;
+
+    std::vector<Segment> segments_;
+    // Номера остановок и расстояния от начала отрезка для всех отрезков подряд
+    std::vector<uint32_t> segment_stops_;
+    std::vector<int> segment_distances_;
+
+    // Вхождения остановок в отрезки в форме CSR по номеру остановки
+    std::vector<size_t> stop_positions_offsets_;
+    std::vector<StopPosition> stop_positions_;
+};
+
+} // end of namespace transport
\ No newline at end of file
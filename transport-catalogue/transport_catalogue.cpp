@@ -14,6 +14,7 @@ void Catalogue::AddStop(const std::string_view title, const geo::Coordinates& co
     stops_.push_back(Stop( std::string(title), coordinates ));
     // Указатель на новую остановку
     Stop* stop = &stops_.back();
+    stop->id = stops_.size() - 1;
     buses_by_stop_[stop->stop_title];
     // Добавление пустого списка автобусов для каждой остановки
     all_stops_[stop->stop_title] = stop;
@@ -26,6 +27,7 @@ void Catalogue::AddRoute(const std::string_view number, const std::vector<Stop*>
     
     // Указатель на новую остановку
     Bus* bus = &buses_.back();
+    bus->id = buses_.size() - 1;
     // Для каждой остановки на маршруте
     for (const Stop* stop : stops) {
         // Добавляем маршрут в список маршрутов, проходящих через эту остановку
@@ -73,6 +75,16 @@ const std::map<std::string_view, Stop*>& Catalogue::GetSortedAllStops() const {
     return all_stops_;
 }
 
+// Метод возвращает список всех остановок в порядке добавления
+const std::deque<Stop>& Catalogue::GetAllStops() const {
+    return stops_;
+}
+
+// Метод возвращает список всех маршрутов в порядке добавления
+const std::deque<Bus>& Catalogue::GetAllBuses() const {
+    return buses_;
+}
+
 //
 serialize::Stop Catalogue::StopsSerialize(const Stop* stop) const {
     serialize::Stop result;
@@ -13,6 +13,8 @@
 
 namespace transport {
 
+// Транспортный каталог. После загрузки каталог не изменяется, и его константные
+// методы можно вызывать из нескольких потоков одновременно
 class Catalogue {
 public:
     // Добавление остановки
@@ -36,6 +38,10 @@ public:
     // Получение отсортированных списков
     const std::map <std::string_view, Bus*>& GetSortedAllBuses() const;
     const std::map <std::string_view, Stop*>& GetSortedAllStops() const;
+    
+    // Получение списков в порядке добавления, позиция совпадает с номером элемента
+    const std::deque<Stop>& GetAllStops() const;
+    const std::deque<Bus>& GetAllBuses() const;
 
     // Сериализация данных каталога
     serialize::Stop StopsSerialize(const Stop* stop) const;
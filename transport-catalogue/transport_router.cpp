@@ -1,16 +1,66 @@
 #include "transport_router.h"
+#include "thread_pool.h"
 
 #include <string>
 #include <string_view>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
 
 namespace transport {
 
 using namespace std::literals;
 
+// Функция возвращает алгоритм поиска по его названию в настройках
+RoutingAlgorithm ParseRoutingAlgorithm(std::string_view name) {
+    if (name == "dijkstra"sv) {
+        return RoutingAlgorithm::DIJKSTRA;
+    }
+    if (name == "all_pairs"sv) {
+        return RoutingAlgorithm::ALL_PAIRS;
+    }
+    if (name == "hub_labels"sv) {
+        return RoutingAlgorithm::HUB_LABELS;
+    }
+    if (name == "contraction_hierarchies"sv) {
+        return RoutingAlgorithm::CONTRACTION_HIERARCHIES;
+    }
+    if (name == "raptor"sv) {
+        return RoutingAlgorithm::RAPTOR;
+    }
+    if (name == "alt"sv) {
+        return RoutingAlgorithm::ALT;
+    }
+    
+    throw std::invalid_argument("Unknown routing algorithm: "s + std::string(name));
+}
+
+// Функция возвращает название алгоритма поиска для настроек
+std::string_view GetRoutingAlgorithmName(RoutingAlgorithm algorithm) {
+    switch (algorithm) {
+    case RoutingAlgorithm::ALL_PAIRS:
+        return "all_pairs"sv;
+    case RoutingAlgorithm::CONTRACTION_HIERARCHIES:
+        return "contraction_hierarchies"sv;
+    case RoutingAlgorithm::RAPTOR:
+        return "raptor"sv;
+    case RoutingAlgorithm::ALT:
+        return "alt"sv;
+    case RoutingAlgorithm::HUB_LABELS:
+        return "hub_labels"sv;
+    case RoutingAlgorithm::DIJKSTRA:
+    default:
+        return "dijkstra"sv;
+    }
+}
+
 Router::Router(const RouteSettings& settings) : route_settings_(settings) {}
 
 // Перегруженный конструктор для построения графов на основе каталога 
@@ -19,100 +69,618 @@ Router::Router(const RouteSettings& settings, const Catalogue& db) : route_setti
 }
 
 // Перегруженный конструктор для построения графов и создания нового объекта
-Router::Router(const RouteSettings& settings, GraphData graph, VertexData vertex)
-    : route_settings_(settings), graph_(graph), stops_vertex_(vertex)
+Router::Router(const RouteSettings& settings, const Catalogue& db, GraphData graph)
+    : route_settings_(settings), db_(&db), graph_(std::move(graph))
 {
-    router_ = new graph::Router<double>(graph_);
+    graph_.Freeze();
+    InitRouter();
 }
 
-// Метод устанавливает новый граф и карту остановок
-void Router::SetGraph(GraphData&& graph, VertexData&& vertex) {
+// Метод устанавливает каталог и построенный по нему граф
+void Router::SetGraph(const Catalogue& db, GraphData&& graph, RoutingData&& routing_data) {
+    db_ = &db;
     graph_ = std::move(graph);
-    stops_vertex_ = std::move(vertex);
-    router_ = new graph::Router<double>(graph_);
+    graph_.Freeze();
+    pending_router_ = std::make_unique<PendingRouter>();
+    pending_router_->routing_data = std::move(routing_data);
+}
+
+// Метод устанавливает каталог и откладывает загрузку графа до первого поиска
+void Router::SetGraph(const Catalogue& db, GraphLoader load_graph) {
+    db_ = &db;
+    graph_ = GraphData();
+    pending_router_ = std::make_unique<PendingRouter>();
+    pending_router_->load_graph = std::move(load_graph);
+}
+
+// Метод загружает граф и создаёт маршрутизатор при первом обращении. Методы поиска
+// константны, а отложенное создание не меняет их результатов, поэтому создаваемые
+// данные объявлены mutable и заполняются однократно под защитой std::call_once
+void Router::EnsureRouter() const {
+    if (!pending_router_) {
+        return;
+    }
+    
+    std::call_once(pending_router_->once, [this] {
+        PendingRouter& pending = *pending_router_;
+        
+        if (pending.load_graph) {
+            pending.load_graph(graph_, pending.routing_data);
+            graph_.Freeze();
+            pending.load_graph = nullptr;
+        }
+        InitRouter(std::exchange(pending.routing_data, {}));
+    });
+}
+
+// Метод создаёт маршрутизатор по выбранному алгоритму.
+// Готовые данные из базы принимаются без повторного расчёта
+void Router::InitRouter(RoutingData&& routing_data) const {
+    pruned_edge_count_ = routing_data.pruned_edge_count;
+    if (!routing_data.stop_positions.empty()) {
+        SetStopPositions(std::move(routing_data.stop_positions));
+    }
+    compact_all_pairs_router_.reset();
+    all_pairs_router_.reset();
+    dijkstra_router_.reset();
+    ch_router_.reset();
+    alt_router_.reset();
+    hub_labels_router_.reset();
+    transit_router_.reset();
+    route_cache_ = std::make_unique<RouteCache>(static_cast<size_t>(std::max(route_settings_.route_cache_size, 0)));
+    
+    switch (route_settings_.routing_algorithm) {
+    case RoutingAlgorithm::ALL_PAIRS:
+        if (routing_data.routes_table) {
+            if (auto* table = std::get_if<CompactAllPairsRouter::RoutesInternalData>(&*routing_data.routes_table)) {
+                compact_all_pairs_router_ = std::make_unique<CompactAllPairsRouter>(graph_, std::move(*table));
+            }
+            else {
+                all_pairs_router_ = std::make_unique<AllPairsRouter>(
+                    graph_, std::get<AllPairsRouter::RoutesInternalData>(std::move(*routing_data.routes_table)));
+            }
+        }
+        else if (IsWaitFolded()) {
+            // Таблица графа с одной вершиной на остановку рассчитывается с теми же суммами
+            // времени, что и таблица графа с вершинами ожидания, поэтому среди маршрутов
+            // равного времени выбираются те же
+            const Weight wait_weight = MinutesToWeight(route_settings_.bus_wait_time);
+            const std::vector<Weight> ride_weights = GetRideWeights();
+            
+            if (CompactAllPairsRouter::CanIndexEdges(graph_.GetEdgeCount())) {
+                compact_all_pairs_router_ = std::make_unique<CompactAllPairsRouter>(graph_, wait_weight, ride_weights,
+                                                                                    GetThreadCount());
+            }
+            else {
+                all_pairs_router_ = std::make_unique<AllPairsRouter>(graph_, wait_weight, ride_weights, GetThreadCount());
+            }
+        }
+        else if (CompactAllPairsRouter::CanIndexEdges(graph_.GetEdgeCount())) {
+            compact_all_pairs_router_ = std::make_unique<CompactAllPairsRouter>(graph_, GetThreadCount());
+        }
+        else {
+            all_pairs_router_ = std::make_unique<AllPairsRouter>(graph_, GetThreadCount());
+        }
+        break;
+    case RoutingAlgorithm::CONTRACTION_HIERARCHIES:
+        ch_router_ = routing_data.contraction_hierarchy
+            ? std::make_unique<graph::ContractionHierarchy<Weight>>(graph_, std::move(*routing_data.contraction_hierarchy))
+            : std::make_unique<graph::ContractionHierarchy<Weight>>(graph_);
+        break;
+    case RoutingAlgorithm::ALT:
+        alt_router_ = routing_data.landmarks
+            ? std::make_unique<graph::AltRouter<Weight>>(graph_, std::move(*routing_data.landmarks))
+            : std::make_unique<graph::AltRouter<Weight>>(graph_, GetLandmarkCount());
+        break;
+    case RoutingAlgorithm::HUB_LABELS:
+        hub_labels_router_ = routing_data.hub_labels
+            ? std::make_unique<graph::HubLabels<Weight>>(graph_, std::move(*routing_data.hub_labels))
+            : std::make_unique<graph::HubLabels<Weight>>(graph_);
+        break;
+    case RoutingAlgorithm::RAPTOR:
+        transit_router_ = std::make_unique<TransitRouter>(*db_, route_settings_.bus_wait_time, route_settings_.bus_velocity);
+        break;
+    case RoutingAlgorithm::DIJKSTRA:
+    default:
+        // Отрицательный размер кэша деревьев, как и кэша ответов, означает отключённый кэш
+        dijkstra_router_ = std::make_unique<graph::DijkstraRouter<Weight>>(
+            graph_, static_cast<size_t>(std::max(route_settings_.trees_cache_size, 0)));
+        break;
+    }
+}
+
+// Метод проверяет, что ожидание автобуса входит в вес рёбер автобусов.
+// Поиск по раундам работает без графа и сам возвращает элементы ожидания
+bool Router::IsWaitFolded() const {
+    return route_settings_.fold_wait_vertices && route_settings_.routing_algorithm != RoutingAlgorithm::RAPTOR;
+}
+
+// Метод возвращает количество потоков построения. Значение настройки хранится
+// как int, поэтому отрицательное значение не должно превращаться в огромное size_t
+size_t Router::GetThreadCount() const {
+    return static_cast<size_t>(std::max(route_settings_.thread_count, 0));
+}
+
+// Метод возвращает количество опорных вершин поиска A* с неотрицательным значением
+size_t Router::GetLandmarkCount() const {
+    return static_cast<size_t>(std::max(route_settings_.landmark_count, 0));
+}
+
+// Метод возвращает вершину ожидания для остановки по её месту в нумерации вершин
+graph::VertexId Router::GetStopVertex(const Stop* stop) const {
+    const size_t position = stop_positions_.empty() ? stop->id : stop_positions_[stop->id];
+    
+    return static_cast<graph::VertexId>(IsWaitFolded() ? position : position * 2);
+}
+
+// Метод возвращает номер остановки по вершине графа с одной вершиной на остановку
+size_t Router::GetVertexStopId(graph::VertexId vertex) const {
+    return position_stops_.empty() ? vertex : position_stops_[vertex];
+}
+
+// Метод устанавливает места остановок в нумерации вершин графа;
+// пустой массив означает нумерацию в порядке каталога
+void Router::SetStopPositions(std::vector<graph::VertexId> stop_positions) const {
+    position_stops_.assign(stop_positions.size(), 0);
+    for (size_t stop_id = 0; stop_id < stop_positions.size(); ++stop_id) {
+        position_stops_.at(stop_positions[stop_id]) = stop_id;
+    }
+    
+    stop_positions_ = std::move(stop_positions);
+}
+
+// Метод добавляет рёбра одного маршрута для всех пар его остановок. Время поездки
+// каждого ребра без ожидания добавляется в ride_weights, если массив передан
+void Router::AddBusEdges(const Bus& bus, std::vector<graph::Edge<Weight>>& edges, std::vector<Weight>* ride_weights) const {
+    const std::vector<Stop*>& stops = bus.stops;
+    const size_t stops_count = stops.size();
+    
+    // Расстояния от начала маршрута до каждой остановки вычисляются один раз,
+    // после чего расстояние между любыми остановками находится разностью
+    std::vector<int> distances(stops_count, 0);
+    for (size_t k = 1; k < stops_count; ++k) {
+        distances[k] = distances[k - 1] + stops[k - 1]->GetStopsDistance(stops[k]);
+    }
+    
+    // Без вершин отправления ребро автобуса выходит из вершины остановки
+    // и включает ожидание перед посадкой
+    const bool is_wait_folded = IsWaitFolded();
+    const Weight wait_weight = MinutesToWeight(route_settings_.bus_wait_time);
+    
+    for (size_t i = 0; i < stops_count; ++i) {
+        for (size_t j = i + 1; j < stops_count; ++j) {
+            const Stop* stop_from = stops[i];
+            const Stop* stop_to = stops[j];
+            const int dist_sum = distances[j] - distances[i];
+            
+            // Добавление ребра графа для автобуса
+            const Weight ride_weight = GetRideWeight(dist_sum, route_settings_.bus_velocity);
+            if (is_wait_folded) {
+                edges.push_back({ static_cast<uint32_t>(bus.id), static_cast<uint32_t>(j - i),
+                                  GetStopVertex(stop_from), GetStopVertex(stop_to), wait_weight + ride_weight });
+            }
+            else {
+                edges.push_back({ static_cast<uint32_t>(bus.id), static_cast<uint32_t>(j - i),
+                                  GetStopVertex(stop_from) + 1, GetStopVertex(stop_to), ride_weight });
+            }
+            if (ride_weights) {
+                ride_weights->push_back(ride_weight);
+            }
+            
+            // Если автобус не является кольцевым и достигнута конечная остановка,
+            // прерываем добавление ребер
+            if (!bus.is_circular && stop_to == bus.final_stop && j == stops_count / 2) {
+                break;
+            }
+        }
+    }
+}
+
+// Метод возвращает время поездки без ожидания для каждого ребра графа с одной вершиной
+// на остановку. Разность веса ребра и ожидания в дробных минутах может отличаться
+// от времени поездки в последнем разряде, поэтому рёбра каждого автобуса строятся
+// заново и сопоставляются с рёбрами графа по концам, количеству участков и весу
+std::vector<Weight> Router::GetRideWeights() const {
+    std::vector<std::vector<graph::EdgeId>> bus_edge_ids(db_->GetAllBuses().size());
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        bus_edge_ids.at(graph_.GetEdge(edge_id).item_id).push_back(edge_id);
+    }
+    
+    std::vector<Weight> result(graph_.GetEdgeCount());
+    std::vector<graph::Edge<Weight>> bus_edges;
+    std::vector<Weight> bus_ride_weights;
+    
+    for (size_t bus_id = 0; bus_id < bus_edge_ids.size(); ++bus_id) {
+        if (bus_edge_ids[bus_id].empty()) {
+            continue;
+        }
+        
+        bus_edges.clear();
+        bus_ride_weights.clear();
+        AddBusEdges(db_->GetAllBuses()[bus_id], bus_edges, &bus_ride_weights);
+        
+        // Рёбра автобуса с одинаковыми концами и количеством участков перебираются в порядке построения
+        std::multimap<std::tuple<graph::VertexId, graph::VertexId, uint32_t>, size_t> bus_edge_indices;
+        for (size_t i = 0; i < bus_edges.size(); ++i) {
+            bus_edge_indices.emplace(std::make_tuple(bus_edges[i].from, bus_edges[i].to, bus_edges[i].quality), i);
+        }
+        
+        for (const graph::EdgeId edge_id : bus_edge_ids[bus_id]) {
+            const graph::Edge<Weight>& edge = graph_.GetEdge(edge_id);
+            const auto [begin, end] = bus_edge_indices.equal_range(std::make_tuple(edge.from, edge.to, edge.quality));
+            const auto it = std::find_if(begin, end, [&](const auto& item) {
+                return bus_edges[item.second].weight == edge.weight;
+            });
+            
+            if (it == end) {
+                throw std::logic_error("Bus edge doesn't match the catalogue");
+            }
+            result[edge_id] = bus_ride_weights[it->second];
+        }
+    }
+    
+    return result;
 }
 
 // Метод строит граф маршрутов на основе транспортного каталога
 const GraphData& Router::BuildGraph(const Catalogue& db) {
-    const std::map<std::string_view, Stop*>& all_stops = db.GetSortedAllStops();
-    const std::map<std::string_view, Bus*>& all_buses = db.GetSortedAllBuses();
-    
-    // Создание графа с удвоенным количеством вершин
-    GraphData stops_graph(all_stops.size() * 2);
-    VertexData stop_vertex;
-    graph::VertexId vertex_id = 0;
-    
-    // Добавление вершин и ребра, связанных с остановками
-    for (const auto& [_, stop] : all_stops) {
-        stop_vertex[stop->stop_title] = vertex_id;
-        stops_graph.AddEdge({ stop->stop_title, 0,
-                              vertex_id, ++vertex_id,
-                              static_cast<double>(route_settings_.bus_wait_time)
-                           });
-        ++vertex_id;
-    }
-    stops_vertex_ = std::move(stop_vertex);
-
-    // Добавление вершин и ребра, связанных с автобусами
-    std::for_each(all_buses.begin(), all_buses.end(),
-             [&stops_graph, this](const auto& item) {
-                 const auto& bus = item.second;
-                 const std::vector<Stop*>& stops = bus->stops;
-                 size_t stops_count = stops.size();
-                 
-                 for (size_t i = 0; i < stops_count; ++i) {
-                     for (size_t j = i + 1; j < stops_count; ++j) {
-                         const Stop* stop_from = stops[i];
-                         const Stop* stop_to = stops[j];
-                         int dist_sum = 0;
-                         
-                         // Вычисление суммарного расстояния между остановками
-                         for (size_t k = i + 1; k <= j; ++k) {
-                             dist_sum += stops[k - 1]->GetStopsDistance(stops[k]);
-                         }
-                         
-                         // Добавление ребра графа для автобуса
-                         stops_graph.AddEdge({ bus->bus_number, j - i, stops_vertex_.at(stop_from->stop_title) + 1,
-                                               stops_vertex_.at(stop_to->stop_title),
-                                               static_cast<double>(dist_sum) / (route_settings_.bus_velocity * (100.0 / 6.0)) }
-                                            );
-                         
-                         // Если автобус не является кольцевым и достигнута конечная остановка,
-                         // прерываем добавление ребер
-                         if (!bus->is_circular && stop_to == bus->final_stop && j == stops_count / 2) {
-                             break;
-                         }
-                     }
-                 }
-             });
-
-    graph_ = std::move(stops_graph);
-    router_ = new graph::Router<double>(graph_);
+    db_ = &db;
+    pending_router_.reset();
+    
+    // Поиск по раундам работает непосредственно по маршрутам каталога, граф ему не нужен
+    if (route_settings_.routing_algorithm == RoutingAlgorithm::RAPTOR) {
+        graph_ = GraphData(0, {});
+        InitRouter();
+        
+        return graph_;
+    }
+    
+    const std::deque<Stop>& all_stops = db.GetAllStops();
+    const std::deque<Bus>& all_buses = db.GetAllBuses();
+    std::vector<graph::Edge<Weight>> edges;
+    
+    const bool is_wait_folded = IsWaitFolded();
+    
+    // Остановки нумеруются вдоль кривой Гильберта, чтобы вершины соседних остановок
+    // и их рёбра располагались в памяти рядом. Иначе вершины нумеруются в порядке
+    // названий остановок: от нумерации зависит выбор среди маршрутов равного времени
+    std::vector<graph::VertexId> stop_positions(all_stops.size());
+    if (route_settings_.hilbert_vertex_order) {
+        std::vector<geo::Coordinates> coords;
+        coords.reserve(all_stops.size());
+        for (const Stop& stop : all_stops) {
+            coords.push_back(stop.coords);
+        }
+        
+        const std::vector<size_t> order = geo::ComputeHilbertOrder(coords);
+        stop_positions.resize(order.size());
+        for (size_t position = 0; position < order.size(); ++position) {
+            stop_positions[order[position]] = static_cast<graph::VertexId>(position);
+        }
+    }
+    else {
+        graph::VertexId position = 0;
+        for (const auto& [_, stop] : db.GetSortedAllStops()) {
+            stop_positions[stop->id] = position++;
+        }
+    }
+    SetStopPositions(std::move(stop_positions));
+    
+    // Добавление ребер ожидания между вершинами каждой остановки в порядке вершин
+    if (!is_wait_folded) {
+        edges.reserve(all_stops.size());
+        for (const size_t stop_id : position_stops_) {
+            const graph::VertexId vertex_id = GetStopVertex(&all_stops[stop_id]);
+            edges.push_back({ static_cast<uint32_t>(stop_id), 0,
+                              vertex_id, vertex_id + 1,
+                              MinutesToWeight(route_settings_.bus_wait_time) });
+        }
+    }
+    
+    // Рёбра маршрутов нумеруются в порядке названий автобусов
+    std::vector<const Bus*> sorted_buses;
+    sorted_buses.reserve(all_buses.size());
+    for (const auto& [_, bus] : db.GetSortedAllBuses()) {
+        sorted_buses.push_back(bus);
+    }
+    
+    // Рёбра маршрутов строятся параллельно: каждая задача заполняет свой буфер
+    // для непрерывного отрезка маршрутов, а буферы объединяются по порядку задач.
+    // Поэтому номера рёбер не зависят от количества потоков
+    parallel::ThreadPool pool(GetThreadCount());
+    const size_t task_count = std::min(sorted_buses.size(), pool.GetThreadCount() * BUILD_TASKS_PER_THREAD);
+    std::vector<std::vector<graph::Edge<Weight>>> task_edges(task_count);
+    
+    pool.ParallelFor(task_count, [&](size_t task) {
+        const size_t begin = sorted_buses.size() * task / task_count;
+        const size_t end = sorted_buses.size() * (task + 1) / task_count;
+        
+        for (size_t i = begin; i < end; ++i) {
+            AddBusEdges(*sorted_buses[i], task_edges[task]);
+        }
+    });
+    
+    size_t edge_count = edges.size();
+    for (const auto& buffer : task_edges) {
+        edge_count += buffer.size();
+    }
+    edges.reserve(edge_count);
+    for (auto& buffer : task_edges) {
+        edges.insert(edges.end(), buffer.begin(), buffer.end());
+        std::vector<graph::Edge<Weight>>().swap(buffer);
+    }
+    
+    const size_t vertex_count = all_stops.size() * (is_wait_folded ? 1 : 2);
+    
+    // Параллельные рёбра, не легче другого ребра той же пары вершин, в кратчайшие пути
+    // не входят и удаляются до создания маршрутизатора и сохранения графа
+    RoutingData routing_data;
+    if (route_settings_.prune_dominated_edges) {
+        routing_data.pruned_edge_count = graph::RemoveDominatedEdges(edges, vertex_count);
+    }
+    
+    // При нумерации вдоль кривой Гильберта рёбра упорядочиваются по начальной вершине,
+    // чтобы рёбра соседних вершин при поиске читались из соседних участков памяти
+    if (route_settings_.hilbert_vertex_order) {
+        std::stable_sort(edges.begin(), edges.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.from < rhs.from;
+        });
+    }
+
+    // Граф с одной или двумя вершинами на остановку создаётся сразу в форме CSR
+    graph_ = GraphData(vertex_count, std::move(edges));
+    InitRouter(std::move(routing_data));
     
     return graph_;
 }
 
+// Функция переводит таблицу маршрутов на тип номеров рёбер большей разрядности
+AllPairsRouter::RoutesInternalData WidenRoutesTable(const CompactAllPairsRouter::RoutesInternalData& routes_table) {
+    AllPairsRouter::RoutesInternalData result{ routes_table.weights, {} };
+    result.prev_edges.reserve(routes_table.prev_edges.size());
+    
+    for (const uint16_t edge_id : routes_table.prev_edges) {
+        result.prev_edges.push_back(edge_id == CompactAllPairsRouter::NONE_EDGE ? AllPairsRouter::NONE_EDGE : edge_id);
+    }
+    
+    return result;
+}
+
+// Метод добавляет рёбра автобуса в граф и обновляет данные маршрутизатора
+void Router::AddBus(const Bus& bus) {
+    if (!db_ || bus.id >= db_->GetAllBuses().size()) {
+        throw std::invalid_argument("Bus should be added to the catalogue first");
+    }
+    EnsureRouter();
+    ClearRouteCache();
+    
+    if (transit_router_) {
+        transit_router_->AddBus(bus);
+        return;
+    }
+    
+    const size_t graph_stop_count = graph_.GetVertexCount() / (IsWaitFolded() ? 1 : 2);
+    for (const Stop* stop : bus.stops) {
+        if (stop->id >= graph_stop_count) {
+            throw std::out_of_range("Stop is not in the routing graph");
+        }
+    }
+    
+    removed_bus_ids_.erase(bus.id);
+    
+    std::vector<graph::Edge<Weight>> edges;
+    AddBusEdges(bus, edges);
+    
+    if (route_settings_.prune_dominated_edges) {
+        pruned_edge_count_ += PruneDominatedEdges(edges);
+    }
+    
+    AddGraphEdges(std::move(edges));
+}
+
+// Метод добавляет рёбра в граф и обновляет данные маршрутизатора
+void Router::AddGraphEdges(std::vector<graph::Edge<Weight>>&& edges) {
+    if (edges.empty()) {
+        return;
+    }
+    
+    // Номера новых рёбер могут не поместиться в компактную таблицу. Таблица расширяется
+    // до добавления рёбер, пока разбиение графа на компоненты совпадает с её разбиением
+    const graph::EdgeId first_edge_id = graph_.GetEdgeCount();
+    if (compact_all_pairs_router_ && !CompactAllPairsRouter::CanIndexEdges(first_edge_id + edges.size())) {
+        all_pairs_router_ = std::make_unique<AllPairsRouter>(
+            graph_, WidenRoutesTable(compact_all_pairs_router_->GetRoutesInternalData()));
+        compact_all_pairs_router_.reset();
+    }
+    
+    for (graph::Edge<Weight>& edge : edges) {
+        graph_.AddEdge(std::move(edge));
+    }
+    graph_.Freeze();
+    
+    if (compact_all_pairs_router_) {
+        compact_all_pairs_router_->AddEdges(first_edge_id, GetThreadCount());
+    }
+    if (all_pairs_router_) {
+        all_pairs_router_->AddEdges(first_edge_id, GetThreadCount());
+    }
+    if (dijkstra_router_) {
+        dijkstra_router_->ClearCache();
+    }
+    if (ch_router_) {
+        ch_router_ = std::make_unique<graph::ContractionHierarchy<Weight>>(graph_);
+    }
+    if (alt_router_) {
+        alt_router_ = std::make_unique<graph::AltRouter<Weight>>(graph_, GetLandmarkCount());
+    }
+    if (hub_labels_router_) {
+        hub_labels_router_ = std::make_unique<graph::HubLabels<Weight>>(graph_);
+    }
+}
+
+// Метод удаляет рёбра автобуса из графа и обновляет данные маршрутизатора
+void Router::RemoveBus(const Bus& bus) {
+    EnsureRouter();
+    ClearRouteCache();
+    
+    if (transit_router_) {
+        transit_router_->RemoveBus(bus);
+        return;
+    }
+    
+    removed_bus_ids_.insert(bus.id);
+    
+    std::vector<graph::EdgeId> edge_ids;
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const graph::Edge<Weight>& edge = graph_.GetEdge(edge_id);
+        
+        if (edge.quality > 0 && edge.item_id == bus.id) {
+            edge_ids.push_back(edge_id);
+        }
+    }
+    
+    if (edge_ids.empty()) {
+        return;
+    }
+    
+    std::vector<graph::Edge<Weight>> replacement_edges;
+    if (route_settings_.prune_dominated_edges) {
+        replacement_edges = FindReplacementEdges(bus, edge_ids);
+    }
+    
+    const std::vector<graph::EdgeId> new_edge_ids = graph_.RemoveEdges(edge_ids);
+    
+    if (compact_all_pairs_router_) {
+        compact_all_pairs_router_->RemoveEdges(new_edge_ids, GetThreadCount());
+    }
+    if (all_pairs_router_) {
+        all_pairs_router_->RemoveEdges(new_edge_ids, GetThreadCount());
+    }
+    if (dijkstra_router_) {
+        dijkstra_router_->ClearCache();
+    }
+    
+    // Рёбра других автобусов, отброшенные при построении графа, возвращаются в граф
+    // вместе с перестроением остальных данных маршрутизатора
+    PruneDominatedEdges(replacement_edges);
+    if (!replacement_edges.empty()) {
+        AddGraphEdges(std::move(replacement_edges));
+        return;
+    }
+    
+    if (ch_router_) {
+        ch_router_ = std::make_unique<graph::ContractionHierarchy<Weight>>(graph_);
+    }
+    if (hub_labels_router_) {
+        hub_labels_router_ = std::make_unique<graph::HubLabels<Weight>>(graph_);
+    }
+    
+    // Расстояния ориентиров после удаления рёбер могут только вырасти,
+    // поэтому прежние расстояния остаются допустимыми нижними оценками
+    if (alt_router_) {
+        alt_router_ = std::make_unique<graph::AltRouter<Weight>>(graph_, LandmarksData(alt_router_->GetData()));
+    }
+}
+
+// Метод отбрасывает рёбра, доминируемые рёбрами графа или предшествующими рёбрами
+// списка с теми же концами. Ребро графа имеет меньший номер, поэтому при равном
+// весе остаётся оно. Возвращает количество отброшенных рёбер
+size_t Router::PruneDominatedEdges(std::vector<graph::Edge<Weight>>& edges) const {
+    const size_t edge_count = edges.size();
+    
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [this](const graph::Edge<Weight>& edge) {
+        for (const graph::EdgeId edge_id : graph_.GetIncidentEdges(edge.from)) {
+            const graph::Edge<Weight>& graph_edge = graph_.GetEdge(edge_id);
+            
+            if (graph_edge.to == edge.to && !(edge.weight < graph_edge.weight)) {
+                return true;
+            }
+        }
+        return false;
+    }), edges.end());
+    graph::RemoveDominatedEdges(edges, graph_.GetVertexCount());
+    
+    return edge_count - edges.size();
+}
+
+// Метод возвращает рёбра остальных автобусов графа между теми же парами вершин,
+// что и удаляемые рёбра автобуса. Такие рёбра могли быть отброшены при построении
+// графа как доминируемые; автобусы перебираются в порядке построения графа
+std::vector<graph::Edge<Weight>> Router::FindReplacementEdges(const Bus& bus,
+                                                              const std::vector<graph::EdgeId>& edge_ids) const
+{
+    auto get_pair_key = [](const graph::Edge<Weight>& edge) {
+        return (static_cast<uint64_t>(edge.from) << 32) | edge.to;
+    };
+    
+    std::unordered_set<uint64_t> pair_keys;
+    for (const graph::EdgeId edge_id : edge_ids) {
+        pair_keys.insert(get_pair_key(graph_.GetEdge(edge_id)));
+    }
+    
+    // Параллельные рёбра есть только у автобусов, проходящих через остановки удаляемого
+    std::vector<const Bus*> buses;
+    for (const Stop* stop : bus.stops) {
+        for (const auto& [_, other] : db_->GetRouteInfo(stop->stop_title)) {
+            if (other->id != bus.id && removed_bus_ids_.count(other->id) == 0) {
+                buses.push_back(other);
+            }
+        }
+    }
+    std::sort(buses.begin(), buses.end(), [](const Bus* lhs, const Bus* rhs) {
+        return lhs->bus_number < rhs->bus_number;
+    });
+    buses.erase(std::unique(buses.begin(), buses.end()), buses.end());
+    
+    std::vector<graph::Edge<Weight>> result;
+    std::vector<graph::Edge<Weight>> bus_edges;
+    for (const Bus* other : buses) {
+        bus_edges.clear();
+        AddBusEdges(*other, bus_edges);
+        
+        for (const graph::Edge<Weight>& edge : bus_edges) {
+            if (pair_keys.count(get_pair_key(edge)) > 0) {
+                result.push_back(edge);
+            }
+        }
+    }
+    
+    return result;
+}
+
 // Метод преобразует ребра графа в элементы массива для JSON
-json::Node Router::GetEdgesItems(const std::vector<graph::EdgeId>& edges) const {
+json::Node Router::GetEdgesItems(const std::vector<graph::Edge<Weight>>& edges) const {
     json::Builder builder;
     auto arrayContext = builder.StartArray();
     
+    auto add_wait_item = [&](size_t stop_id, Weight weight) {
+        auto dictContext = arrayContext.StartDict();
+        dictContext.Key("stop_name"s).Value(db_->GetAllStops()[stop_id].stop_title);
+        dictContext.Key("time"s).Value(WeightToMinutes(weight));
+        dictContext.Key("type"s).Value("Wait"s);
+        dictContext.EndDict();
+    };
+    
+    const bool is_wait_folded = IsWaitFolded();
+    const Weight wait_weight = MinutesToWeight(route_settings_.bus_wait_time);
+    
     // Создание массива элементов ребер графа для передачи в формат JSON
-    for (auto& edge_id : edges) {
-        const graph::Edge<double>& edge = graph_.GetEdge(edge_id);
-        
+    for (const graph::Edge<Weight>& edge : edges) {
         if (edge.quality == 0) {
-            auto dictContext = arrayContext.StartDict();
-            dictContext.Key("stop_name"s).Value(static_cast<std::string>(edge.name));
-            dictContext.Key("time"s).Value(edge.weight);
-            dictContext.Key("type"s).Value("Wait"s);
-            dictContext.EndDict();
+            add_wait_item(edge.item_id, edge.weight);
         }
         else {
+            // Ожидание, входящее в вес ребра автобуса, выводится отдельным элементом
+            Weight ride_weight = edge.weight;
+            if (is_wait_folded) {
+                add_wait_item(GetVertexStopId(edge.from), wait_weight);
+                ride_weight -= wait_weight;
+            }
+            
             auto dictContext = arrayContext.StartDict();
-            dictContext.Key("bus"s).Value(static_cast<std::string>(edge.name));
+            dictContext.Key("bus"s).Value(db_->GetAllBuses()[edge.item_id].bus_number);
             dictContext.Key("span_count"s).Value(static_cast<int>(edge.quality));
-            dictContext.Key("time"s).Value(edge.weight);
+            dictContext.Key("time"s).Value(WeightToMinutes(ride_weight));
             dictContext.Key("type"s).Value("Bus"s);
             dictContext.EndDict();
         }
@@ -121,31 +689,410 @@ json::Node Router::GetEdgesItems(const std::vector<graph::EdgeId>& edges) const
     return arrayContext.EndArray().Build();
 }
 
+// Метод выводит элементы рёбер графа в том же виде, что и GetEdgesItems,
+// ключи словарей передаются в порядке возрастания
+void Router::WriteEdgesItems(json::Writer& writer, const std::vector<graph::Edge<Weight>>& edges) const {
+    auto write_wait_item = [&](size_t stop_id, Weight weight) {
+        writer.StartDict()
+            .Key("stop_name"sv).Value(db_->GetAllStops()[stop_id].stop_title)
+            .Key("time"sv).Value(WeightToMinutes(weight))
+            .Key("type"sv).Value("Wait"sv)
+            .EndDict();
+    };
+    
+    const bool is_wait_folded = IsWaitFolded();
+    const Weight wait_weight = MinutesToWeight(route_settings_.bus_wait_time);
+    
+    for (const graph::Edge<Weight>& edge : edges) {
+        if (edge.quality == 0) {
+            write_wait_item(edge.item_id, edge.weight);
+            continue;
+        }
+        
+        Weight ride_weight = edge.weight;
+        if (is_wait_folded) {
+            write_wait_item(GetVertexStopId(edge.from), wait_weight);
+            ride_weight -= wait_weight;
+        }
+        
+        writer.StartDict()
+            .Key("bus"sv).Value(db_->GetAllBuses()[edge.item_id].bus_number)
+            .Key("span_count"sv).Value(static_cast<int>(edge.quality))
+            .Key("time"sv).Value(WeightToMinutes(ride_weight))
+            .Key("type"sv).Value("Bus"sv)
+            .EndDict();
+    }
+}
+
 // Метод возвращает информацию о маршруте между остановками
-std::optional<graph::Router<double>::RouteInfo> Router::GetRouteInfo(const Stop* current, const Stop* next) const {
-    return router_->BuildRoute(stops_vertex_.at(current->stop_title), stops_vertex_.at(next->stop_title));
+std::optional<RouteInfo> Router::GetRouteInfo(const Stop* current, const Stop* next) const {
+    EnsureRouter();
+    
+    if (transit_router_) {
+        return transit_router_->BuildRoute(current, next);
+    }
+    
+    const graph::VertexId from = GetStopVertex(current);
+    const graph::VertexId to = GetStopVertex(next);
+    
+    if (compact_all_pairs_router_) {
+        return MakeRouteInfo(compact_all_pairs_router_->BuildRoute(from, to));
+    }
+    if (all_pairs_router_) {
+        return MakeRouteInfo(all_pairs_router_->BuildRoute(from, to));
+    }
+    if (ch_router_) {
+        return MakeRouteInfo(ch_router_->BuildRoute(from, to));
+    }
+    if (hub_labels_router_) {
+        return MakeRouteInfo(hub_labels_router_->BuildRoute(from, to));
+    }
+    if (alt_router_) {
+        return MakeRouteInfo(alt_router_->BuildRoute(from, to));
+    }
+    
+    return MakeRouteInfo(dijkstra_router_->BuildRoute(from, to));
+}
+
+// Метод строит маршрут в буферы вызывающего. Таблица всех пар обходит путь
+// в буфер номеров рёбер и сразу записывает рёбра в маршрут, остальные
+// алгоритмы строят маршрут обычным образом
+bool Router::BuildRoute(const Stop* from, const Stop* to, RouteScratch& scratch) const {
+    EnsureRouter();
+    
+    RouteInfo& route = scratch.route;
+    route.edges.clear();
+    
+    auto add_edge = [&route](const graph::Edge<Weight>& edge) {
+        route.edges.push_back(edge);
+    };
+    
+    std::optional<Weight> weight;
+    if (compact_all_pairs_router_) {
+        weight = compact_all_pairs_router_->VisitRoute(GetStopVertex(from), GetStopVertex(to), scratch.path, add_edge);
+    }
+    else if (all_pairs_router_) {
+        weight = all_pairs_router_->VisitRoute(GetStopVertex(from), GetStopVertex(to), scratch.path, add_edge);
+    }
+    else if (auto result = GetRouteInfo(from, to)) {
+        route = std::move(*result);
+        return true;
+    }
+    
+    if (!weight) {
+        return false;
+    }
+    route.weight = *weight;
+    
+    return true;
+}
+
+// Метод проверяет, отвечает ли маршрутизатор на отдельные запросы без поиска
+bool Router::HasFastSingleRoutes() const {
+    EnsureRouter();
+    
+    return compact_all_pairs_router_ || all_pairs_router_ || ch_router_ || hub_labels_router_;
+}
+
+// Метод возвращает маршруты от одной остановки до нескольких
+std::vector<std::optional<RouteInfo>> Router::GetRoutesInfo(const Stop* from, const std::vector<const Stop*>& to) const {
+    EnsureRouter();
+    
+    std::vector<std::optional<RouteInfo>> result;
+    result.reserve(to.size());
+    
+    // Таблица всех пар и иерархия сокращений отвечают на отдельные запросы быстрее,
+    // чем поиск от остановки до всех целей; для одной цели общий поиск тоже не нужен
+    if (to.size() == 1 || HasFastSingleRoutes()) {
+        for (const Stop* stop : to) {
+            result.push_back(GetRouteInfo(from, stop));
+        }
+        
+        return result;
+    }
+    
+    if (transit_router_) {
+        return transit_router_->BuildRoutes(from, to);
+    }
+    
+    std::vector<graph::VertexId> targets;
+    targets.reserve(to.size());
+    for (const Stop* stop : to) {
+        targets.push_back(GetStopVertex(stop));
+    }
+    
+    if (dijkstra_router_) {
+        for (auto& route : dijkstra_router_->BuildRoutes(GetStopVertex(from), targets)) {
+            result.push_back(MakeRouteInfo(std::move(route)));
+        }
+        
+        return result;
+    }
+    
+    // Поиск A* с ориентирами направлен к одной цели, поэтому маршруты группы строятся
+    // по отдельности, и каждый из них учитывается в счётчиках поиска
+    for (const graph::VertexId target : targets) {
+        result.push_back(MakeRouteInfo(alt_router_->BuildRoute(GetStopVertex(from), target)));
+    }
+    
+    return result;
+}
+
+// Функция возвращает ключ кэша ответов по вершинам ожидания остановок
+uint64_t GetRouteCacheKey(graph::VertexId from, graph::VertexId to) {
+    return (static_cast<uint64_t>(from) << 32) | to;
+}
+
+// Метод ищет построенный маршрут в кэше
+std::shared_ptr<const RouteInfo> Router::FindCachedRoute(const Stop* from, const Stop* to) const {
+    EnsureRouter();
+    
+    if (!route_cache_) {
+        return nullptr;
+    }
+    
+    std::optional<std::shared_ptr<const RouteInfo>> route;
+    {
+        std::lock_guard guard(route_cache_->mutex);
+        route = route_cache_->routes.Get(GetRouteCacheKey(GetStopVertex(from), GetStopVertex(to)));
+    }
+    
+    if (!route) {
+        ++route_cache_->miss_count;
+        return nullptr;
+    }
+    ++route_cache_->hit_count;
+    
+    return *route;
+}
+
+// Метод сохраняет маршрут в кэше. Размер маршрута оценивается по его рёбрам
+// и блоку управления разделяемого указателя
+void Router::CacheRoute(const Stop* from, const Stop* to, std::shared_ptr<const RouteInfo> route) const {
+    static constexpr size_t SHARED_BLOCK_OVERHEAD = 16;
+    
+    EnsureRouter();
+    
+    if (!route_cache_) {
+        return;
+    }
+    
+    const size_t size = sizeof(RouteInfo) + SHARED_BLOCK_OVERHEAD + route->edges.capacity() * sizeof(graph::Edge<Weight>);
+    
+    std::lock_guard guard(route_cache_->mutex);
+    route_cache_->routes.Put(GetRouteCacheKey(GetStopVertex(from), GetStopVertex(to)), std::move(route), size);
+}
+
+void Router::CacheRoute(const Stop* from, const Stop* to, const RouteInfo& route) const {
+    EnsureRouter();
+    
+    if (route_cache_) {
+        CacheRoute(from, to, std::make_shared<const RouteInfo>(route));
+    }
+}
+
+// Метод удаляет маршруты из кэша, сохраняя его ёмкость и счётчики
+void Router::ClearRouteCache() {
+    if (!route_cache_) {
+        return;
+    }
+    
+    std::lock_guard guard(route_cache_->mutex);
+    route_cache_->routes = cache::LruCache<uint64_t, std::shared_ptr<const RouteInfo>>(
+        route_cache_->routes.GetCapacity());
+}
+
+// Метод возвращает матрицу времени в пути между остановками
+std::vector<TravelTimes> Router::GetTravelTimes(const std::vector<const Stop*>& from,
+                                                const std::vector<const Stop*>& to) const
+{
+    EnsureRouter();
+    
+    std::vector<TravelTimes> result(from.size());
+    std::unordered_map<const Stop*, size_t> computed_rows;
+    
+    // Вершины известных остановок прибытия и соответствующие им столбцы матрицы
+    std::vector<graph::VertexId> targets;
+    std::vector<size_t> target_columns;
+    for (size_t column = 0; column < to.size(); ++column) {
+        if (to[column]) {
+            targets.push_back(GetStopVertex(to[column]));
+            target_columns.push_back(column);
+        }
+    }
+    
+    // Рабочие массивы поиска создаются один раз на всю матрицу
+    TransitRouter::SearchState transit_state;
+    std::unique_ptr<graph::OneToManySearch<Weight>> search;
+    std::vector<std::optional<Weight>> weights(targets.size());
+    
+    if (!transit_router_ && !compact_all_pairs_router_ && !all_pairs_router_ && !hub_labels_router_) {
+        search = std::make_unique<graph::OneToManySearch<Weight>>(graph_);
+    }
+    
+    for (size_t row = 0; row < from.size(); ++row) {
+        TravelTimes& times = result[row];
+        
+        if (!from[row]) {
+            times.assign(to.size(), std::nullopt);
+            continue;
+        }
+        if (const auto it = computed_rows.find(from[row]); it != computed_rows.end()) {
+            times = result[it->second];
+            continue;
+        }
+        computed_rows[from[row]] = row;
+        
+        if (transit_router_) {
+            transit_router_->BuildTravelTimes(from[row], to, transit_state, times);
+            continue;
+        }
+        
+        const graph::VertexId source = GetStopVertex(from[row]);
+        
+        if (search) {
+            search->Run(source, targets, weights);
+        }
+        else if (hub_labels_router_) {
+            for (size_t i = 0; i < targets.size(); ++i) {
+                weights[i] = hub_labels_router_->GetRouteWeight(source, targets[i]);
+            }
+        }
+        else {
+            for (size_t i = 0; i < targets.size(); ++i) {
+                weights[i] = compact_all_pairs_router_ ? compact_all_pairs_router_->GetRouteWeight(source, targets[i])
+                                                       : all_pairs_router_->GetRouteWeight(source, targets[i]);
+            }
+        }
+        
+        times.assign(to.size(), std::nullopt);
+        for (size_t i = 0; i < targets.size(); ++i) {
+            times[target_columns[i]] = weights[i];
+        }
+    }
+    
+    return result;
+}
+
+// Метод возвращает остановки, достижимые от остановки from не дольше max_weight
+StopArrivals Router::GetReachableStops(const Stop* from, Weight max_weight, RouteScratch& scratch) const {
+    EnsureRouter();
+    
+    StopArrivals result;
+    
+    if (transit_router_) {
+        transit_router_->BuildStopArrivals(from, max_weight, scratch.transit_state, result);
+    }
+    else {
+        // Поиск идёт по графу маршрутов при любом алгоритме: ограниченная область
+        // просматривается быстрее, чем таблицы и метки до всех остановок
+        if (!scratch.search) {
+            scratch.search = std::make_unique<graph::OneToManySearch<Weight>>(graph_);
+        }
+        scratch.search->RunBounded(GetStopVertex(from), max_weight, scratch.reached);
+        
+        // Время прибытия на остановку - вес пути до её вершины ожидания
+        const bool is_wait_folded = IsWaitFolded();
+        for (const auto& [vertex, weight] : scratch.reached) {
+            if (is_wait_folded) {
+                result.emplace_back(GetVertexStopId(vertex), weight);
+            }
+            else if (vertex % 2 == 0) {
+                result.emplace_back(GetVertexStopId(vertex / 2), weight);
+            }
+        }
+    }
+    
+    // Остановки с равным временем упорядочиваются по номеру, чтобы ответ не зависел от алгоритма
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+    });
+    
+    return result;
+}
+
+// Метод заменяет номера рёбер маршрута самими рёбрами графа
+std::optional<RouteInfo> Router::MakeRouteInfo(std::optional<graph::RouteInfo<Weight>> route) const {
+    if (!route) {
+        return std::nullopt;
+    }
+    
+    RouteInfo result{ route->weight, {} };
+    result.edges.reserve(route->edges.size());
+    
+    for (const graph::EdgeId edge_id : route->edges) {
+        result.edges.push_back(graph_.GetEdge(edge_id));
+    }
+    
+    return result;
 }
 
 // Метод возвращает количество вершин в графе
-size_t Router::GetGraphVertexCount() {
+size_t Router::GetGraphVertexCount() const {
+    EnsureRouter();
+    
     return graph_.GetVertexCount();
 }
 
 // Метод возвращает константную ссылку на объект и позволяет получить доступ к построенному графу
 const GraphData& Router::GetGraph() const {
+    EnsureRouter();
+    
     return graph_;
 }
 
-// Метод возвращает соответствия идентификаторов остановок и их названий
-const VertexData& Router::GetStopsVertex() const {
-    return stops_vertex_;
-}
-
 // Метод возвращает объект, содержащий настройки маршрутизатора
 json::Node Router::GetSettings() const {
     return json::Builder{}.StartDict()
         .Key("bus_wait_time"s).Value(route_settings_.bus_wait_time)
         .Key("bus_velocity"s).Value(route_settings_.bus_velocity)
+        .Key("routing_algorithm"s).Value(std::string(GetRoutingAlgorithmName(route_settings_.routing_algorithm)))
+        .Key("trees_cache_size"s).Value(route_settings_.trees_cache_size)
+        .Key("store_routes_table"s).Value(route_settings_.store_routes_table)
+        .Key("thread_count"s).Value(route_settings_.thread_count)
+        .Key("landmark_count"s).Value(route_settings_.landmark_count)
+        .Key("route_cache_size"s).Value(route_settings_.route_cache_size)
+        .Key("fold_wait_vertices"s).Value(route_settings_.fold_wait_vertices)
+        .Key("prune_dominated_edges"s).Value(route_settings_.prune_dominated_edges)
+        .Key("hilbert_vertex_order"s).Value(route_settings_.hilbert_vertex_order)
+        .EndDict().Build();
+}
+
+// Метод возвращает счётчики поиска маршрутов для алгоритмов, выполняющих поиск по запросу,
+// счётчики кэша ответов и количество доминируемых рёбер, удалённых из графа
+json::Node Router::GetStats() const {
+    EnsureRouter();
+    
+    graph::SearchStats stats;
+    
+    if (alt_router_) {
+        stats = alt_router_->GetStats();
+    }
+    else if (dijkstra_router_) {
+        stats = dijkstra_router_->GetStats();
+    }
+    
+    size_t cache_hits = 0;
+    size_t cache_misses = 0;
+    size_t cache_size = 0;
+    
+    if (route_cache_) {
+        cache_hits = route_cache_->hit_count.load();
+        cache_misses = route_cache_->miss_count.load();
+        
+        std::lock_guard guard(route_cache_->mutex);
+        cache_size = route_cache_->routes.GetSize();
+    }
+    
+    return json::Builder{}.StartDict()
+        .Key("routing_algorithm"s).Value(std::string(GetRoutingAlgorithmName(route_settings_.routing_algorithm)))
+        .Key("route_queries"s).Value(static_cast<int>(stats.query_count))
+        .Key("settled_vertices"s).Value(static_cast<int>(stats.settled_vertex_count))
+        .Key("route_cache_hits"s).Value(static_cast<int>(cache_hits))
+        .Key("route_cache_misses"s).Value(static_cast<int>(cache_misses))
+        .Key("route_cache_size"s).Value(static_cast<int>(cache_size))
+        .Key("route_cache_capacity"s).Value(route_settings_.route_cache_size)
+        .Key("pruned_edges"s).Value(static_cast<int>(pruned_edge_count_))
         .EndDict().Build();
 }
 
@@ -160,6 +1107,16 @@ serialize::RouterSettings Router::RouterSettingSerialize(const json::Node& route
     
     result.set_bus_wait_time(rs_map.at("bus_wait_time"s).AsInt());
     result.set_bus_velocity(rs_map.at("bus_velocity"s).AsDouble());
+    result.set_routing_algorithm(static_cast<serialize::RoutingAlgorithm>(
+        ParseRoutingAlgorithm(rs_map.at("routing_algorithm"s).AsString())));
+    result.set_trees_cache_size(rs_map.at("trees_cache_size"s).AsInt());
+    result.set_store_routes_table(rs_map.at("store_routes_table"s).AsBool());
+    result.set_thread_count(rs_map.at("thread_count"s).AsInt());
+    result.set_landmark_count(rs_map.at("landmark_count"s).AsInt());
+    result.set_route_cache_size(rs_map.at("route_cache_size"s).AsInt());
+    result.set_fold_wait_vertices(rs_map.at("fold_wait_vertices"s).AsBool());
+    result.set_prune_dominated_edges(rs_map.at("prune_dominated_edges"s).AsBool());
+    result.set_hilbert_vertex_order(rs_map.at("hilbert_vertex_order"s).AsBool());
     
     return result;
 }
@@ -167,48 +1124,133 @@ serialize::RouterSettings Router::RouterSettingSerialize(const json::Node& route
 serialize::Graph GraphSerialize(const GraphData& g) {
     serialize::Graph result;
     
-    size_t vertex_count = g.GetVertexCount();
     size_t edge_count = g.GetEdgeCount();
     
     for (size_t i = 0; i < edge_count; ++i) {
         serialize::Edge s_edge;
         
-        const graph::Edge<double>& edge = g.GetEdge(i);
+        const graph::Edge<Weight>& edge = g.GetEdge(i);
         
-        s_edge.set_name(edge.name);
+        s_edge.set_item_id(edge.item_id);
         s_edge.set_quality(edge.quality);
         s_edge.set_from(edge.from);
         s_edge.set_to(edge.to);
-        s_edge.set_weight(edge.weight);
+        s_edge.set_weight(WeightToMinutes(edge.weight));
         
         *result.add_edge() = s_edge;
     }
-    for (size_t i = 0; i < vertex_count; ++i) {
-        serialize::Vertex vertex;
+    
+    // Граф сериализуется в форме CSR без промежуточных списков смежности
+    const auto& offsets = g.GetIncidentEdgesOffsets();
+    const auto& incident_edges = g.GetIncidentEdges();
+    result.mutable_incident_edges_offset()->Add(offsets.begin(), offsets.end());
+    result.mutable_incident_edge()->Add(incident_edges.begin(), incident_edges.end());
+    
+    return result;
+}
+
+// Таблица маршрутов записывается единым бинарным блоком: массив весов путей,
+// за которым следует массив номеров последних рёбер
+template <typename RoutesInternalData>
+std::string RoutesTableSerialize(const RoutesInternalData& routes_table) {
+    const auto& weights = routes_table.weights;
+    const auto& prev_edges = routes_table.prev_edges;
+    std::string result;
+    
+    result.reserve(weights.size() * sizeof(weights[0]) + prev_edges.size() * sizeof(prev_edges[0]));
+    result.append(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(weights[0]));
+    result.append(reinterpret_cast<const char*>(prev_edges.data()), prev_edges.size() * sizeof(prev_edges[0]));
+    
+    return result;
+}
+
+serialize::ContractionHierarchy ContractionHierarchySerialize(const ContractionData& data) {
+    serialize::ContractionHierarchy result;
+    
+    for (const size_t rank : data.ranks) {
+        result.add_rank(rank);
+    }
+    for (const auto& shortcut : data.shortcuts) {
+        serialize::Shortcut s_shortcut;
         
-        for (const auto& edge_id : g.GetIncidentEdges(i)) {
-            vertex.add_edge_id(edge_id);
-        }
+        s_shortcut.set_from(shortcut.from);
+        s_shortcut.set_to(shortcut.to);
+        s_shortcut.set_weight(WeightToMinutes(shortcut.weight));
+        s_shortcut.set_first(shortcut.first);
+        s_shortcut.set_second(shortcut.second);
         
-        *result.add_vertex() = vertex;
+        *result.add_shortcut() = s_shortcut;
+    }
+    
+    return result;
+}
+
+serialize::Landmarks LandmarksSerialize(const LandmarksData& data) {
+    serialize::Landmarks result;
+    
+    result.mutable_landmark()->Add(data.landmarks.begin(), data.landmarks.end());
+    
+    // Расстояния хранятся в минутах независимо от типа весов сборки
+    for (const Weight distance : data.forward_distances) {
+        result.add_forward_distance(WeightToMinutes(distance));
+    }
+    for (const Weight distance : data.backward_distances) {
+        result.add_backward_distance(WeightToMinutes(distance));
+    }
+    
+    return result;
+}
+
+// Метки хабов хранятся упакованными массивами, веса - в минутах
+serialize::HubLabels HubLabelsSerialize(const HubLabelsData& data) {
+    serialize::HubLabels result;
+    
+    result.mutable_hub()->Add(data.hubs.begin(), data.hubs.end());
+    result.mutable_forward_offset()->Add(data.forward_offsets.begin(), data.forward_offsets.end());
+    result.mutable_backward_offset()->Add(data.backward_offsets.begin(), data.backward_offsets.end());
+    
+    for (const auto& entry : data.forward_labels) {
+        result.add_forward_hub(entry.hub);
+        result.add_forward_edge(entry.edge);
+        result.add_forward_weight(WeightToMinutes(entry.weight));
+    }
+    for (const auto& entry : data.backward_labels) {
+        result.add_backward_hub(entry.hub);
+        result.add_backward_edge(entry.edge);
+        result.add_backward_weight(WeightToMinutes(entry.weight));
     }
     
     return result;
 }
 
 serialize::Router Router::RouterSerialize(const Router& router) const {
+    router.EnsureRouter();
+    
     serialize::Router result;
     
     *result.mutable_router_settings() = RouterSettingSerialize(router.GetSettings());
     *result.mutable_graph() = GraphSerialize(router.GetGraph());
+    result.set_pruned_edge_count(router.pruned_edge_count_);
+    result.mutable_stop_position()->Add(router.stop_positions_.begin(), router.stop_positions_.end());
     
-    for (const auto& [name, id] : router.GetStopsVertex()) {
-        serialize::StopId si;
-        
-        si.set_name(name);
-        si.set_id(id);
-        
-        *result.add_stop_id() = si;
+    if (router.route_settings_.store_routes_table && router.compact_all_pairs_router_) {
+        result.set_routes_table(RoutesTableSerialize(router.compact_all_pairs_router_->GetRoutesInternalData()));
+        result.set_routes_table_edge_index_size(sizeof(uint16_t));
+        result.set_routes_table_integer_weights(HAS_INTEGER_WEIGHTS);
+    }
+    if (router.route_settings_.store_routes_table && router.all_pairs_router_) {
+        result.set_routes_table(RoutesTableSerialize(router.all_pairs_router_->GetRoutesInternalData()));
+        result.set_routes_table_edge_index_size(sizeof(uint32_t));
+        result.set_routes_table_integer_weights(HAS_INTEGER_WEIGHTS);
+    }
+    if (router.ch_router_) {
+        *result.mutable_contraction_hierarchy() = ContractionHierarchySerialize(router.ch_router_->GetData());
+    }
+    if (router.alt_router_) {
+        *result.mutable_landmarks() = LandmarksSerialize(router.alt_router_->GetData());
+    }
+    if (router.hub_labels_router_) {
+        *result.mutable_hub_labels() = HubLabelsSerialize(router.hub_labels_router_->GetData());
     }
     
     return result;
@@ -4,51 +4,189 @@
 #include "transport_catalogue.h"
 #include "graph.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "alt_router.h"
+#include "hub_labels.h"
+#include "transit_router.h"
+#include "lru_cache.h"
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string_view>
+#include <unordered_set>
+#include <variant>
 
 namespace transport {
 
+// Алгоритм поиска кратчайших путей
+enum class RoutingAlgorithm {
+    // Поиск Дейкстры по запросу с кэшем деревьев кратчайших путей
+    DIJKSTRA,
+    // Предрасчёт таблицы кратчайших путей для всех пар вершин
+    ALL_PAIRS,
+    // Иерархия сокращений, построенная при создании базы
+    CONTRACTION_HIERARCHIES,
+    // Поиск по раундам на маршрутах каталога без построения графа
+    RAPTOR,
+    // Поиск A* с оценками по ориентирам, рассчитанным при создании базы
+    ALT,
+    // Слияние меток хабов, рассчитанных при создании базы
+    HUB_LABELS,
+};
+
+// Преобразование названия алгоритма из настроек и обратно
+RoutingAlgorithm ParseRoutingAlgorithm(std::string_view name);
+std::string_view GetRoutingAlgorithmName(RoutingAlgorithm algorithm);
+
 // Структура, описывающая настройки маршрута
 struct RouteSettings {
     // Время ожидания автобуса на остановке
     int bus_wait_time;
     // Скорость движения автобуса
     double bus_velocity;
+    // Алгоритм поиска кратчайших путей
+    RoutingAlgorithm routing_algorithm = RoutingAlgorithm::ALL_PAIRS;
+    // Количество деревьев кратчайших путей, хранимых в кэше
+    int trees_cache_size = static_cast<int>(graph::DijkstraRouter<Weight>::DEFAULT_CACHE_SIZE);
+    // Признак сохранения таблицы всех пар вершин в базу
+    bool store_routes_table = false;
+    // Количество потоков для построения графа и предрасчёта маршрутов (0 - все ядра)
+    int thread_count = 0;
+    // Количество ориентиров для поиска A*
+    int landmark_count = static_cast<int>(graph::AltRouter<Weight>::DEFAULT_LANDMARK_COUNT);
+    // Объём кэша готовых ответов на запросы маршрутов в байтах (0 - кэш отключён)
+    int route_cache_size = 16 << 20;
+    // Одна вершина графа на остановку: время ожидания автобуса входит в вес рёбер
+    // автобусов, а элемент ожидания восстанавливается при выводе маршрута
+    bool fold_wait_vertices = false;
+    // Удаление параллельных рёбер, доминируемых другими рёбрами той же пары вершин
+    bool prune_dominated_edges = false;
+    // Нумерация вершин графа вдоль кривой Гильберта по координатам остановок
+    bool hilbert_vertex_order = false;
 };
 
 // Объявление синонимов
-using GraphData = graph::DirectedWeightedGraph<double>;
-using VertexData = std::map<std::string, graph::VertexId>;
-    
+using GraphData = graph::DirectedWeightedGraph<Weight>;
+
+// Маршрутизаторы с таблицей всех пар вершин. Для номеров рёбер в таблице
+// выбирается наименьший тип, вмещающий все рёбра графа
+using CompactAllPairsRouter = graph::Router<Weight, uint16_t>;
+using AllPairsRouter = graph::Router<Weight, uint32_t>;
+using RoutesTable = std::variant<CompactAllPairsRouter::RoutesInternalData, AllPairsRouter::RoutesInternalData>;
+using ContractionData = graph::ContractionHierarchy<Weight>::Data;
+using LandmarksData = graph::AltRouter<Weight>::Data;
+using HubLabelsData = graph::HubLabels<Weight>::Data;
+
+// Данные предварительного расчёта маршрутов, загружаемые из базы
+struct RoutingData {
+    std::optional<RoutesTable> routes_table;
+    std::optional<ContractionData> contraction_hierarchy;
+    std::optional<LandmarksData> landmarks;
+    std::optional<HubLabelsData> hub_labels;
+    // Количество доминируемых рёбер, удалённых при построении графа
+    size_t pruned_edge_count = 0;
+    // Места остановок в нумерации вершин графа; пустой массив - порядок каталога
+    std::vector<graph::VertexId> stop_positions;
+};
+
+// Загрузка графа и данных предрасчёта маршрутов, выполняемая при первом поиске маршрута
+using GraphLoader = std::function<void(GraphData& graph, RoutingData& routing_data)>;
+
+// Маршрутизатор транспортного каталога. Константные методы поиска маршрутов можно
+// вызывать из нескольких потоков одновременно: отложенное создание маршрутизатора
+// выполняется однократно, а кэши деревьев и маршрутов защищены мьютексами.
+// Методы, изменяющие граф (SetGraph, BuildGraph, AddBus, RemoveBus), не должны
+// выполняться одновременно с поиском
 class Router {
 public:
+    // Рабочие буферы построения маршрута, переиспользуемые между запросами
+    struct RouteScratch {
+        RouteInfo route;
+        std::vector<graph::EdgeId> path;
+        // Буферы поиска достижимых остановок создаются при первом запросе
+        std::unique_ptr<graph::OneToManySearch<Weight>> search;
+        std::vector<std::pair<graph::VertexId, Weight>> reached;
+        TransitRouter::SearchState transit_state;
+    };
+
     Router() = default;
 
     // Конструктор, принимающий узел с настройками
     Router(const RouteSettings& settings);
     // Конструктор, принимающий узел с настройками и каталог
     Router(const RouteSettings& settings, const Catalogue& db);
-    // Конструктор, принимающий узел с настройками, граф и идентификаторы остановок
-    Router(const RouteSettings& settings, GraphData graph, VertexData vertex); 
+    // Конструктор, принимающий узел с настройками, каталог и построенный по нему граф
+    Router(const RouteSettings& settings, const Catalogue& db, GraphData graph);
+
+    // Установка каталога, построенного по нему графа и, при наличии, данных предрасчёта маршрутов
+    // Маршрутизатор создаётся при первом обращении к поиску маршрутов
+    void SetGraph(const Catalogue& db, GraphData&& graph, RoutingData&& routing_data = {});
 
-    // Установка графа и вершин остановок
-    void SetGraph(GraphData&& graph, VertexData&& vertex);
+    // Установка каталога и отложенной загрузки графа. Граф загружается, а маршрутизатор
+    // создаётся при первом обращении к поиску маршрутов из любого потока, поэтому
+    // запросы без поиска маршрутов не тратят время на их подготовку
+    void SetGraph(const Catalogue& db, GraphLoader load_graph);
 
     // Построение графа на основе каталога
     const GraphData& BuildGraph(const Catalogue& db);
 
+    // Добавление в граф рёбер автобуса, уже добавленного в каталог, без перестроения графа.
+    // Таблица всех пар обновляется инкрементально, кэш деревьев сбрасывается,
+    // иерархия сокращений и ориентиры рассчитываются заново
+    void AddBus(const Bus& bus);
+
+    // Удаление из графа рёбер автобуса; в каталоге автобус остаётся.
+    // Строки таблицы всех пар пересчитываются, только если их пути проходили через автобус
+    void RemoveBus(const Bus& bus);
+
     // Получение массива элементов ребер графа
-    json::Node GetEdgesItems(const std::vector<graph::EdgeId>& edges) const;
+    json::Node GetEdgesItems(const std::vector<graph::Edge<Weight>>& edges) const;
+
+    // Вывод элементов рёбер графа в открытый массив без построения узлов JSON
+    void WriteEdgesItems(json::Writer& writer, const std::vector<graph::Edge<Weight>>& edges) const;
 
     // Получение информации о маршруте от текущей остановки до следующей
-    std::optional<graph::Router<double>::RouteInfo> GetRouteInfo(const Stop* current, const Stop* next) const;
+    std::optional<RouteInfo> GetRouteInfo(const Stop* current, const Stop* next) const;
 
-    // Получение количества вершин в графе
-    size_t GetGraphVertexCount();
+    // Построение маршрута в буферы вызывающего; возвращает false, если маршрут не найден.
+    // По таблице всех пар маршрут восстанавливается без выделения памяти
+    bool BuildRoute(const Stop* from, const Stop* to, RouteScratch& scratch) const;
+
+    // Признак маршрутизатора, отвечающего на отдельные запросы быстрее общего поиска
+    // от остановки отправления до нескольких целей
+    bool HasFastSingleRoutes() const;
+
+    // Получение маршрутов от одной остановки до нескольких. Дейкстра и поиск по раундам
+    // отвечают на все маршруты по результатам одного поиска от остановки отправления
+    std::vector<std::optional<RouteInfo>> GetRoutesInfo(const Stop* from, const std::vector<const Stop*>& to) const;
+
+    // Поиск построенного маршрута в кэше; обращение учитывается
+    // в счётчиках попаданий и промахов
+    std::shared_ptr<const RouteInfo> FindCachedRoute(const Stop* from, const Stop* to) const;
 
-    // Получение идентификаторов остановок
-    const VertexData& GetStopsVertex() const;
+    // Сохранение построенного маршрута в кэше. Маршрут из буфера копируется,
+    // только если кэш включён
+    void CacheRoute(const Stop* from, const Stop* to, std::shared_ptr<const RouteInfo> route) const;
+    void CacheRoute(const Stop* from, const Stop* to, const RouteInfo& route) const;
+
+    // Получение матрицы времени в пути между остановками без восстановления маршрутов.
+    // Поиск выполняется один раз для каждой различной остановки отправления,
+    // неизвестные остановки передаются как nullptr
+    std::vector<TravelTimes> GetTravelTimes(const std::vector<const Stop*>& from,
+                                            const std::vector<const Stop*>& to) const;
+
+    // Получение остановок, время в пути до которых не больше max_weight, в порядке
+    // возрастания времени. Поиск ограничен этим временем и просматривает только
+    // достижимую часть сети
+    StopArrivals GetReachableStops(const Stop* from, Weight max_weight, RouteScratch& scratch) const;
+
+    // Получение количества вершин в графе
+    size_t GetGraphVertexCount() const;
 
     // Получение графа
     const GraphData& GetGraph() const;
@@ -56,25 +194,123 @@ public:
     // Получение настроек
     json::Node GetSettings() const;
 
+    // Получение счётчиков поиска маршрутов
+    json::Node GetStats() const;
+
     // Методы для сериализации данных
     serialize::RouterSettings RouterSettingSerialize(const json::Node& router_settings) const;
     
     serialize::Router RouterSerialize(const transport::Router& router) const;
-    
-    // Деструктор
-    ~Router() {
-        delete router_;
-    }
 
 private:
+    // Создание маршрутизатора по выбранному в настройках алгоритму. Метод константный,
+    // потому что вызывается и из EnsureRouter; он изменяет только mutable-члены
+    void InitRouter(RoutingData&& routing_data = {}) const;
+
+    // Однократная загрузка графа и создание маршрутизатора, если они отложены
+    void EnsureRouter() const;
+
+    // Признак графа с одной вершиной на остановку, в котором нет рёбер ожидания
+    bool IsWaitFolded() const;
+
+    // Количество потоков из настроек; 0 и отрицательные значения означают все ядра
+    size_t GetThreadCount() const;
+
+    // Количество опорных вершин из настроек; отрицательное значение считается нулём
+    size_t GetLandmarkCount() const;
+
+    // Вершина ожидания автобуса на остановке; вершина отправления следует за ней.
+    // В графе с одной вершиной на остановку её номер совпадает с номером остановки
+    graph::VertexId GetStopVertex(const Stop* stop) const;
+
+    // Остановка вершины графа с одной вершиной на остановку
+    size_t GetVertexStopId(graph::VertexId vertex) const;
+
+    // Установка мест остановок в нумерации вершин и обратного соответствия
+    void SetStopPositions(std::vector<graph::VertexId> stop_positions) const;
+
+    // Преобразование маршрута по графу в последовательность его рёбер
+    std::optional<RouteInfo> MakeRouteInfo(std::optional<graph::RouteInfo<Weight>> route) const;
+
+    // Построение рёбер графа для всех пар остановок маршрута
+    void AddBusEdges(const Bus& bus, std::vector<graph::Edge<Weight>>& edges,
+                     std::vector<Weight>* ride_weights = nullptr) const;
+
+    // Время поездки без ожидания для каждого ребра графа с одной вершиной на остановку
+    std::vector<Weight> GetRideWeights() const;
+
+    // Добавление рёбер в граф с обновлением таблицы всех пар и перестроением
+    // остальных данных маршрутизатора
+    void AddGraphEdges(std::vector<graph::Edge<Weight>>&& edges);
+
+    // Отбрасывание рёбер, доминируемых рёбрами графа или друг другом
+    size_t PruneDominatedEdges(std::vector<graph::Edge<Weight>>& edges) const;
+
+    // Рёбра остальных автобусов между парами вершин удаляемых рёбер автобуса
+    std::vector<graph::Edge<Weight>> FindReplacementEdges(const Bus& bus,
+                                                          const std::vector<graph::EdgeId>& edge_ids) const;
+
+    // Количество задач построения графа на один поток для выравнивания нагрузки
+    static constexpr size_t BUILD_TASKS_PER_THREAD = 8;
+
+    // Кэш построенных маршрутов по паре вершин остановок. Ёмкость задаётся в байтах,
+    // каждый маршрут учитывается с оценкой занимаемой им памяти.
+    // Кэш разделяется всеми потоками, обслуживающими запросы
+    struct RouteCache {
+        explicit RouteCache(size_t capacity) : routes(capacity) {}
+
+        std::mutex mutex;
+        cache::LruCache<uint64_t, std::shared_ptr<const RouteInfo>> routes;
+        std::atomic<size_t> hit_count = 0;
+        std::atomic<size_t> miss_count = 0;
+    };
+
+    // Отложенное создание маршрутизатора; загрузчик и данные предрасчёта
+    // освобождаются после создания
+    struct PendingRouter {
+        std::once_flag once;
+        GraphLoader load_graph;
+        RoutingData routing_data;
+    };
+
+    // Сброс маршрутов кэша после изменения графа; счётчики сохраняются
+    void ClearRouteCache();
+
     RouteSettings route_settings_;
     
+    // Каталог, по которому построен граф; рёбра ссылаются на его остановки и маршруты
+    const Catalogue* db_ = nullptr;
+    // Данные для создания маршрутизатора при первом обращении
+    std::unique_ptr<PendingRouter> pending_router_;
+    // Автобусы каталога, рёбра которых удалены из графа
+    std::unordered_set<size_t> removed_bus_ids_;
+    
+    // Граф и маршрутизаторы при отложенной загрузке создаются в константных методах поиска
+    // внутри std::call_once (EnsureRouter). После создания константные методы их не изменяют,
+    // кроме кэшей, защищённых собственными мьютексами
+    
     // Граф
-    GraphData graph_; 
-    // Идентификаторы остановок и их вершины
-    VertexData stops_vertex_; 
-    // Указатель на объект класса Router
-    graph::Router<double>* router_ = nullptr; 
+    mutable GraphData graph_;
+    // Маршрутизатор с предрасчётом всех пар вершин
+    mutable std::unique_ptr<CompactAllPairsRouter> compact_all_pairs_router_;
+    mutable std::unique_ptr<AllPairsRouter> all_pairs_router_;
+    // Маршрутизатор, выполняющий поиск по запросу
+    mutable std::unique_ptr<graph::DijkstraRouter<Weight>> dijkstra_router_;
+    // Маршрутизатор на основе иерархии сокращений
+    mutable std::unique_ptr<graph::ContractionHierarchy<Weight>> ch_router_;
+    // Маршрутизатор, выполняющий поиск A* по ориентирам
+    mutable std::unique_ptr<graph::AltRouter<Weight>> alt_router_;
+    // Оракул расстояний на метках хабов
+    mutable std::unique_ptr<graph::HubLabels<Weight>> hub_labels_router_;
+    // Маршрутизатор, работающий по маршрутам каталога без графа
+    mutable std::unique_ptr<TransitRouter> transit_router_;
+    // Кэш построенных маршрутов
+    mutable std::unique_ptr<RouteCache> route_cache_;
+    // Количество доминируемых рёбер, отброшенных при построении графа и добавлении автобусов
+    mutable size_t pruned_edge_count_ = 0;
+    // Места остановок в нумерации вершин графа и остановки по местам
+    mutable std::vector<graph::VertexId> stop_positions_;
+    mutable std::vector<size_t> position_stops_;
 };
 
 } // end of namespace transport
\ No newline at end of file